@@ -0,0 +1,109 @@
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "nrf24_avr.h"
+#include "radiocfg.h"
+#include "report.h"
+#include "uart.h"
+#include "telem.h"
+
+/*
+ Estação base: ouve os relatórios dos carrinhos (REPORT_ENABLE no
+ carrinho.c) nos seis pipes do nRF24L01+, um por LASER_PLAYER, e repassa
+ cada um pela serial assim que chega (TELEM_CAR), para o tools/based montar
+ o registro da partida. Fica no canal fixo RADIO_CHANNEL e não confirma
+ nada: os carrinhos enviam sem ACK e não esperam a base.
+
+ Uma placa só com o rádio (mesma pinagem do carrinho: CE no D9, CSN no D10)
+ e a USB; a serial fica livre para a telemetria o tempo todo.
+*/
+
+/*** CONFIGURAÇÃO ***/
+#define BASE_STATS_MS 1000 // Intervalo dos registros TELEM_BASE
+#define BASE_LED      PC4  // Troca de estado a cada relatório recebido
+
+/**
+ * @brief Relógio de 1ms do Timer1 (CTC), só para o carimbo da telemetria.
+ */
+volatile uint16_t ms_ticks = 0;
+ISR(TIMER1_COMPA_vect) {
+  ms_ticks++;
+}
+
+void timer1_setup(void) {
+  TCCR1A = 0;
+  TCCR1B = (1<<WGM12) | (1<<CS11);  // CTC, prescaler de 8
+  OCR1A = F_CPU / 8 / 1000 - 1;
+  TIMSK1 = (1<<OCIE1A);
+}
+
+uint16_t ticks_ms(void) {
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t t = ms_ticks;
+  SREG = sreg;
+  return t;
+}
+
+TelemBase stats;
+
+/**
+ * @brief Pipe 0 com o endereço completo do carrinho 0; os pipes 1..5 com o
+ * do pipe 1, mudando só o byte menos significativo (limite do rádio).
+ */
+void radio_setup(void) {
+  const Nrf24Config radio = {
+    RADIO_CHANNEL, sizeof(CarReport), 0x03, RADIO_RF_SETUP, 0, 0, 1, {REPORT_ADDR_LSB, REPORT_ADDR_TAIL},
+  };
+  nrf24_begin_config(9, 10, RF24_SPI_SPEED, &radio);
+  for (uint8_t p = 1; p < REPORT_PIPES; p++) {
+    const uint8_t addr[5] = {REPORT_ADDR_LSB + p, REPORT_ADDR_TAIL};
+    nrf24_openReadingPipe(p, addr);
+  }
+  nrf24_setAutoAck(0);
+  nrf24_startListening();
+}
+
+/**
+ * @brief Esvazia a FIFO de RX e repassa cada relatório.
+ *
+ * A terceira leitura seguida quer dizer que a FIFO estava cheia quando a
+ * rajada começou: um relatório pode ter sido descartado pelo rádio (o
+ * tools/based vê a falha no seq).
+ */
+void receive(void) {
+  TelemCar r;
+  uint8_t burst = 0;
+
+  while (nrf24_availablePipe(&r.pipe)) {
+    nrf24_read(&r.report, sizeof(r.report));
+    r.fifo = ++burst;
+    if (burst == 3) stats.full++;
+    stats.reports[r.pipe]++;
+    PORTC ^= (1 << BASE_LED);
+    telem_send(TELEM_CAR, ticks_ms(), &r, sizeof(r));
+  }
+}
+
+int main(void) {
+  DDRC |= (1 << BASE_LED);
+  timer1_setup();
+  uart_begin();
+  sei();
+  radio_setup();
+
+  uint16_t stats_ms = ticks_ms();
+  while (1) {
+    receive();
+
+    uint16_t now = ticks_ms();
+    if ((uint16_t)(now - stats_ms) >= BASE_STATS_MS) {
+      stats_ms = now;
+      stats.dropped = telem_dropped;
+      telem_send(TELEM_BASE, now, &stats, sizeof(stats));
+    }
+  }
+}
@@ -0,0 +1,167 @@
+#ifndef TELEM_H
+#define TELEM_H
+
+#include <stdint.h>
+#include <assert.h>
+
+/*
+ Registro da telemetria na serial (little-endian, como no AVR):
+
+   byte 0      0xA5  sincronismo
+   byte 1      tipo  (TelemType)
+   byte 2      len   bytes de carga (até TELEM_MAX_PAYLOAD)
+   byte 3-4    ts    relógio do firmware em ms
+   byte 5..    carga (uma das structs abaixo)
+   último      soma  complemento da soma dos bytes 1 a 4+len
+
+ Quem lê procura o 0xA5 e só aceita o registro se a soma bater, então pode
+ começar no meio do fluxo. Registros que não cabem na fila são descartados
+ inteiros (contados em telem_dropped), nunca cortados.
+*/
+#define TELEM_SYNC        0xA5
+#define TELEM_HEADER      5
+#define TELEM_MAX_PAYLOAD 24
+#define TELEM_MAX_RECORD  (TELEM_HEADER + TELEM_MAX_PAYLOAD + 1)
+
+typedef enum {
+  TELEM_RESET = 1,  // TelemReset: no boot
+  TELEM_BOOT,       // TelemBoot: no primeiro quadro aceito (carrinho) ou confirmado (controle)
+  TELEM_LOOP,       // TelemLoop: tempo do laço, por janela
+  TELEM_LINK,       // TelemLink: estatísticas do enlace (carrinho)
+  TELEM_HIT,        // TelemHit: tiro recebido (carrinho)
+  TELEM_POWER,      // TelemPower: consumo (controle)
+  TELEM_TRACE,      // até 6 TraceEntry (trace.h), sob demanda
+  TELEM_HIST,       // TelemHist: meio histograma (hist.h), sob demanda
+  TELEM_CAPTURE,    // TelemCapture e as amostras do LDR, a cada período (carrinho)
+  TELEM_FRAME,      // quadro do rádio como foi lido, no período da leitura (carrinho)
+  TELEM_CAR,        // TelemCar (report.h): relatório de um carrinho recebido pela base
+  TELEM_BASE,       // TelemBase (report.h): recepção da base, periódico
+  TELEM_LTEST,      // TelemLinkTest: uma janela do teste de enlace (linktest/)
+  TELEM_TYPES
+} TelemType;
+
+typedef struct {
+  uint32_t restart_us;  // do main() ao primeiro período do laço, sem bancada/calibração
+  uint8_t  cause;       // ResetCause
+  uint8_t  stalled;     // tarefas que faltavam no último estouro do watchdog
+  uint16_t count[5];    // resets por ResetCause
+} TelemReset;
+
+typedef struct {
+  uint8_t  warm;
+  uint8_t  channel;
+  uint16_t radio_us;
+  uint32_t first_us;
+} TelemBoot;
+
+typedef struct {
+  uint16_t periods;   // períodos (carrinho) ou envios (controle) na janela
+  uint16_t avg_us;    // trabalho médio por período
+  uint16_t max_us;    // maior trabalho na janela
+  uint16_t late;      // comando pronto depois da atuação
+  uint16_t overruns;  // trabalho maior que o período
+} TelemLoop;
+
+typedef struct {
+  uint16_t accepted;
+  uint16_t duplicated;
+  uint16_t reordered;
+  uint16_t lost;
+  uint16_t recovered;
+  uint16_t resyncs;   // salto de frequência (0 sem HOP_ENABLE)
+  uint8_t  latency;   // ms acima do menor atraso visto
+  uint8_t  channel;
+} TelemLink;
+
+typedef struct {
+  uint8_t  shooter;   // jogador (0..3)
+  uint8_t  life;      // LEDs de vida depois do tiro
+  int16_t  score;     // saída do correlador
+  int16_t  threshold; // limiar no momento do tiro
+  uint8_t  ambient;   // luz ambiente no LDR (LDR_AMBIENT, 0..255)
+  uint8_t  active;    // bit por jogador: na mira no momento do tiro
+} TelemHit;
+
+typedef struct {
+  uint16_t duty;      // 1/1000 do tempo acordado
+  uint16_t awake_us;  // por envio
+  uint16_t sends;
+  uint16_t failed;    // envios sem ACK (MAX_RT ou vencidos)
+  uint16_t superseded; // amostras trocadas por uma mais nova antes de ir ao ar (txbox.h)
+  uint16_t expired;   // quadros que passaram do TXBOX_DEADLINE_MS, no ar ou esperando
+} TelemPower;
+
+typedef struct {
+  uint8_t  id;        // HistId
+  uint8_t  first;     // primeiro bucket deste registro (0 ou 8)
+  uint16_t max;       // maior amostra do histograma, contagens de 0,5us
+  uint16_t count[8];
+} TelemHist;
+
+/*
+ Captura para o tools/carreplay (CAPTURE_ENABLE no carrinho): um registro
+ por período, no sense(), com a saída e a vida que o período anterior deixou
+ e as amostras do LDR que a interrupção do ADC tratou desde o sense()
+ anterior, na ordem. Se o laço atrasou e as amostras não couberam, samples
+ tem CAPTURE_OVERFLOW e o replay para ali.
+*/
+typedef struct {
+  int16_t  left;      // saída da última atuação (MotorCmd)
+  int16_t  right;
+  uint8_t  life;
+  uint8_t  samples;   // amostras que seguem (até TELEM_CAPTURE_SAMPLES)
+} TelemCapture;
+
+#define TELEM_CAPTURE_SAMPLES (TELEM_MAX_PAYLOAD - sizeof(TelemCapture))
+#define CAPTURE_OVERFLOW      0x80
+
+/*
+ Teste de enlace (linktest/), por janela de window_ms, de um dos lados. No
+ transmissor, packets são os envios confirmados (ou só enviados, sem ACK),
+ lost os que esgotaram as retransmissões e retries as retransmissões; o
+ jitter é o atraso do começo de cada envio em relação à grade de LT_RATE_HZ.
+ No receptor, packets são os pacotes novos, lost os buracos no seq, dup os
+ repetidos (o ACK se perdeu e o transmissor mandou de novo) e o jitter o
+ desvio de cada intervalo entre chegadas em relação à grade do transmissor.
+ Cada lado deixa em zero os contadores do outro (retries no RX, dup e
+ reordered no TX).
+*/
+typedef struct {
+  uint16_t packets;
+  uint16_t lost;
+  uint16_t retries;     // retransmissões (transmissor)
+  uint16_t dup;         // seq igual ao último (receptor)
+  uint16_t reordered;   // seq menor que o último (receptor)
+  uint16_t jitter_avg;  // us
+  uint16_t jitter_max;
+  uint16_t window_ms;
+  uint8_t  tx;          // 1 = transmissor
+  uint8_t  payload;     // bytes por pacote
+  uint8_t  data_rate;   // rf24_datarate_e
+  uint8_t  channel;
+} TelemLinkTest;
+
+static_assert(sizeof(TelemReset) == 16);
+static_assert(sizeof(TelemBoot)  == 8);
+static_assert(sizeof(TelemLoop)  == 10);
+static_assert(sizeof(TelemLink)  == 14);
+static_assert(sizeof(TelemHit)   == 8);
+static_assert(sizeof(TelemPower) == 12);
+static_assert(sizeof(TelemHist)  == 20);
+static_assert(sizeof(TelemCapture) == 6);
+static_assert(sizeof(TelemLinkTest) == 20);
+
+/**
+ * @brief Soma do registro (bytes 1 a 4+len), a mesma no firmware e no PC.
+ */
+static inline uint8_t telem_checksum(const uint8_t *rec, uint8_t len) {
+  uint8_t sum = 0;
+  for (uint8_t i = 1; i < TELEM_HEADER + len; i++) sum += rec[i];
+  return ~sum;
+}
+
+extern uint16_t telem_dropped;
+
+uint8_t telem_send(uint8_t type, uint16_t ts, const void *payload, uint8_t len);
+
+#endif
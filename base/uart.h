@@ -0,0 +1,22 @@
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+#include <assert.h>
+
+/*** CONFIGURAÇÃO ***/
+#define UART_BAUD    1000000 // Com U2X: 16MHz / 8 / (UBRR + 1), exato em 1M, 500k e 250k
+#define UART_TX_SIZE 128     // Fila de envio em bytes (potência de 2, até 256)
+
+#define UART_UBRR (F_CPU / 8 / UART_BAUD - 1)
+static_assert((UART_TX_SIZE & (UART_TX_SIZE - 1)) == 0 && UART_TX_SIZE <= 256);
+static_assert(F_CPU % (8UL * UART_BAUD) == 0); // sem erro de baud
+
+void    uart_begin(void);
+uint8_t uart_free(void);
+uint8_t uart_write(const void *buf, uint8_t len);
+void    uart_flush(void);
+uint8_t uart_busy(void);
+int16_t uart_read(void);
+
+#endif
@@ -2,9 +2,25 @@
 #define F_CPU 16000000UL
 #endif
 
+#include <stdbool.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
 #include "nrf24_avr.h"
+#include "radiocfg.h"
+#include "hop.h"
+#include "frame.h"
+#include "drive.h"
+#include "pwm.h"
+#include "laser.h"
+#include "ldr.h"
+#include "wdog.h"
+#include "uart.h"
+#include "telem.h"
+#include "trace.h"
+#include "hist.h"
+#include "report.h"
 
 #define HIGH 1
 #define LOW  0
@@ -26,25 +42,116 @@
 #define IS_PRESSED (!(PIND & (1<<7)))
 #define BTN 7
 
-#define LASER 0
+#define CONTROL_HZ       1000 // Frequência do laço de controle (500 ou 1000)
+#define ACTUATE_PHASE_US 400  // Atraso da atuação em relação ao início do período
+#define CMD_TIMEOUT_MS   100  // Sem quadro válido por esse tempo, para os motores
+#define WDOG_TIMEOUT     WDTO_30MS // Laço travado: motores parados em até 2 períodos, reset no 3º
+//#define TELEM_ENABLE          // Telemetria na serial: PD1 (TXD) é o IN2 da ponte H, só na bancada
+#define TELEM_LOOP_PERIODS 250  // Períodos do laço por registro TELEM_LOOP
+#define TELEM_LINK_MS      500  // Intervalo dos registros TELEM_LINK
+//#define TRACE_ENABLE          // Rastro de eventos; o botão de debug envia pela telemetria
+//#define HIST_ENABLE           // Histogramas de tempo do laço e das ISRs; o botão de debug envia
+//#define CAPTURE_ENABLE        // Grava quadros e amostras do LDR para o tools/carreplay (~22kB/s)
+//#define REPORT_ENABLE         // Envia vida, tiros e enlace para a estação base (base/), sem ACK
+
+#define TICK_MS     (1000 / CONTROL_HZ)
+#define TIMER1_TOP  (F_CPU / 8 / CONTROL_HZ - 1)
+#define ACTUATE_OCR (ACTUATE_PHASE_US * (F_CPU / 8 / 1000000UL))
+static_assert(1000 % CONTROL_HZ == 0);
+static_assert(ACTUATE_OCR < TIMER1_TOP);
+
+// Cada período do laço precisa chegar à ponte H: pelo menos um BOTTOM por período
+static_assert(PWM_HZ(PWM_LEFT_MODE,  PWM_LEFT_PRESCALER)  >= CONTROL_HZ);
+static_assert(PWM_HZ(PWM_RIGHT_MODE, PWM_RIGHT_PRESCALER) >= CONTROL_HZ);
+
+#ifdef TELEM_ENABLE
+#define TELEM(type, payload) telem_send((type), ticks_ms(), &(payload), sizeof(payload))
+#else
+#define TELEM(type, payload) ((void)(payload))
+#endif
 
-const uint8_t addr[5] = {'0', '0', '0', '0', '1'};
+#ifdef TRACE_ENABLE
+#ifndef TELEM_ENABLE
+#error "TRACE_ENABLE precisa de TELEM_ENABLE para enviar o rastro"
+#endif
+#define TRACE(id, arg) trace_put(&trace, (id), (arg))
+Trace trace;
+#elif defined(BENCH_MARKS)
+// make bench: cada ponto do rastro vira uma escrita em GPIOR0, que o
+// tools/avrbench marca com o ciclo exato do simulador
+#define TRACE(id, arg) (GPIOR0 = (id))
+#else
+#define TRACE(id, arg) ((void)0)
+#endif
 
-/**
- * @brief Estrutura recebida do controle remoto contendo eixos e botões.
- * @note Tamanho garantido em 4 bytes.
- */
-typedef struct {
-  int8_t x;
-  int8_t y;
-  int8_t sw;
-  int8_t trigger;
-} Controls;
-static_assert(sizeof(Controls) == 4);
+#ifdef HIST_ENABLE
+#ifndef TELEM_ENABLE
+#error "HIST_ENABLE precisa de TELEM_ENABLE para enviar os histogramas"
+#endif
+#define HIST_START(t)       uint16_t t = hist_clock()
+#define HIST_LAP(id, since) hist_lap(&hist[id], &(since))
+#define HIST_ADD(id, v)     hist_add(&hist[id], (v))
+Hist hist[HIST_IDS];
+uint16_t period_start;
+#else
+#define HIST_START(t)
+#define HIST_LAP(id, since) ((void)0)
+#define HIST_ADD(id, v)     ((void)0)
+#endif
+
+#ifdef CAPTURE_ENABLE
+#ifndef TELEM_ENABLE
+#error "CAPTURE_ENABLE precisa de TELEM_ENABLE para enviar a captura"
+#endif
+#define CAPTURE_RING 32 // Amostras do LDR entre dois sense() (~10 por período a 1kHz)
+static_assert(CAPTURE_RING >= TELEM_CAPTURE_SAMPLES);
+static_assert(sizeof(Frame) <= TELEM_MAX_PAYLOAD);
+#endif
+
+#ifdef REPORT_ENABLE
+#ifdef HOP_ENABLE
+#error "REPORT_ENABLE precisa do canal fixo: a base só ouve RADIO_CHANNEL"
+#endif
+static_assert(LASER_PLAYERS <= REPORT_SHOOTERS && LASER_PLAYER < REPORT_PIPES);
+#endif
+
+// Tarefas que precisam rodar entre duas interrupções do watchdog
+#define TASK_SENSE   (1<<0)
+#define TASK_RECEIVE (1<<1)
+#define TASK_CONTROL (1<<2)
+#define TASK_ACTUATE (1<<3) // COMPB do Timer1
+#define TASK_ALL     (TASK_SENSE | TASK_RECEIVE | TASK_CONTROL | TASK_ACTUATE)
+
+#define PWM_BENCH_DUTY 180  // PWM dos motores no modo bancada
+#define PWM_BENCH_MS   5000 // tempo em cada frequência
+
+#ifdef REPORT_ENABLE
+#define RADIO_FEATURE (1<<EN_DYN_ACK) // relatórios sem ACK
+#else
+#define RADIO_FEATURE 0
+#endif
+
+// SETUP_RETR fica no valor de reset (0x03): o carrinho só recebe
+const Nrf24Config radio_config = {
+  RADIO_CHANNEL, sizeof(Frame), 0x03, RADIO_RF_SETUP, RADIO_FEATURE, 0, 1, RADIO_ADDRESS,
+};
 
 uint8_t life = 0b1110;
 bool on=false, pressed=false, prev=false;
-bool ldr_prev = false;
+
+FrameRx link;
+Controls last_gamepad = {0, 0, 1, 1};
+uint16_t last_cmd_ms = 0;
+uint16_t penalty_ms = 0; // tempo restante da penalidade de game over
+
+#ifdef HOP_ENABLE
+HopRx hop;
+#endif
+
+#ifdef REPORT_ENABLE
+uint8_t hits_by[REPORT_SHOOTERS]; // tiros recebidos de cada jogador desde o boot
+bool report_hit = false;          // tiro novo: relatório no próximo período
+#endif
 
 /**
  * @brief Retorna o valor absoluto de um inteiro.
@@ -53,53 +160,123 @@ int abs(int num) {
   return num >= 0 ? num : num * -1;
 }
 
+/**
+ * @brief Configura o Timer1 como relógio do laço de controle.
+ *
+ * COMPA marca o início de cada período (CONTROL_HZ) e COMPB, ACTUATE_PHASE_US
+ * depois, aplica nos motores o comando calculado nesse período.
+ */
 void timer1_setup() {
     TCCR1A = 0;
-    TCCR1B = (1<<CS12) | (1<<CS10);   // Prescaler de 1024
-    TCNT1 = 49911;
-    TIMSK1 = (1<<TOIE1);
+    TCCR1B = (1<<WGM12) | (1<<CS11);  // CTC, prescaler de 8 (0,5us por contagem)
+    OCR1A = TIMER1_TOP;
+    OCR1B = ACTUATE_OCR;
+    TIMSK1 = (1<<OCIE1A) | (1<<OCIE1B);
 }
 
-volatile uint8_t ovf_count = 0;
-ISR(TIMER1_OVF_vect) {
-  TCNT1 = 49911; // preload para a espera de 1s
-  ovf_count++;
+volatile uint16_t ms_ticks = 0;
+volatile uint8_t control_tick = 0;
+ISR(TIMER1_COMPA_vect) {
+  HIST_ADD(HIST_TICK_LAT, TCNT1);  // o CTC zerou o TCNT1 no compare
+  ms_ticks += TICK_MS;
+  laser_tick();
+  control_tick = 1;
 }
 
-void delay_sec(uint8_t seconds) {
-    ovf_count = 0;
-    TCNT1 = 49911;
+/**
+ * @brief Lê o contador de milissegundos sem ser interrompido no meio.
+ */
+uint16_t ticks_ms(void) {
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t t = ms_ticks;
+  SREG = sreg;
+  return t;
+}
 
-    while (ovf_count < seconds);
+/**
+ * @brief Captura o Timer1 em us desde o timer1_setup() (até ~65s).
+ */
+uint32_t timer1_us(void) {
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t t = TCNT1;
+  uint16_t ms = ms_ticks;
+  if ((TIFR1 & (1<<OCF1A)) && t < TIMER1_TOP / 2) ms += TICK_MS; // tick pendente
+  SREG = sreg;
+  return (uint32_t)ms * 1000 + t / 2;
 }
 
 /**
- * @brief Configura o ADC e os PWM usados.
+ * @brief timer1_us() em 16 bits, para o rastro (só contas de 16 bits).
+ *
+ * Chamada com as interrupções desligadas (trace_put()).
  */
-void analog_setup(void) {
-  ADMUX = (1 << REFS0);
-  ADCSRA = (1 << ADEN) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+uint16_t trace_clock(void) {
+  uint16_t t = TCNT1;
+  uint16_t ms = ms_ticks;
+  if ((TIFR1 & (1<<OCF1A)) && t < TIMER1_TOP / 2) ms += TICK_MS;
+  return ms * 1000u + t / 2;
+}
+
+/**
+ * @brief Timer1 em contagens (0,5us) desde o boot, em 16 bits, para hist.h.
+ */
+uint16_t hist_clock(void) {
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t t = TCNT1;
+  uint16_t ms = ms_ticks;
+  if ((TIFR1 & (1<<OCF1A)) && t < TIMER1_TOP / 2) ms += TICK_MS;
+  SREG = sreg;
+  return ms * (uint16_t)(F_CPU / 8 / 1000) + t;
+}
 
-  DDRD |= (1 << PD6);
-  TCCR0A = (1<<WGM00) | (1<<WGM01) | (1<<COM0A1);
-  TCCR0B = (1<<CS01);
+BootStats boot;
+
+LdrDetector ldr;
+volatile uint8_t ldr_hit = 0; // 1 + jogador do último tiro, 0 se nenhum
+
+/**
+ * @brief Amostra do LDR: o ADC roda livre e cada conversão passa pelo detector.
+ *
+ * Só o tiro detectado vai para o rastro: uma entrada por conversão (~9,6kHz)
+ * encheria o buffer em poucos milissegundos.
+ */
+#ifdef CAPTURE_ENABLE
+uint8_t cap_buf[CAPTURE_RING];
+volatile uint8_t cap_count = 0; // amostras desde o último sense(); passa de CAPTURE_RING se perdeu
+#endif
 
-  DDRD |= (1 << PD3);
-  TCCR2A = (1<<WGM20) | (1<<WGM21) | (1<<COM2B1);
-  TCCR2B = (1<<CS21);
+ISR(ADC_vect) {
+  uint8_t value = ADCH;
+  uint8_t shooter = ldr_sample(&ldr, value);
+#ifdef CAPTURE_ENABLE
+  uint8_t n = cap_count;
+  if (n < CAPTURE_RING) cap_buf[n] = value;
+  if (n <= CAPTURE_RING) cap_count = n + 1;
+#endif
+  if (shooter) {
+    ldr_hit = shooter;
+    TRACE(TR_ADC, shooter - 1);
+  }
 }
 
 /**
- * @brief Lê um canal analógico (ADC0–ADC7).
- * @param channel Canal a ler.
- * @return Valor de 0 a 1023.
+ * @brief Configura o ADC e os PWM usados.
+ *
+ * O ADC fica dedicado ao LDR, em modo livre, com o resultado alinhado à
+ * esquerda para a interrupção ler só os 8 bits de cima.
  */
-uint16_t analog_read(uint8_t channel) {
-    channel &= 0x07;
-    ADMUX = (ADMUX & 0xF0) | channel;
-    ADCSRA |= (1 << ADSC);
-    while (ADCSRA & (1 << ADSC));
-    return ADC;
+void analog_setup(void) {
+  ldr_begin(&ldr);
+  ADMUX = (1 << REFS0) | (1 << ADLAR) | LDR;
+  ADCSRB = 0;
+  DIDR0 = (1 << ADC0D);
+  ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADATE) | (1 << ADIE)
+         | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+
+  pwm_setup(PWM_LEFT_DEFAULT, PWM_RIGHT_DEFAULT);
 }
 
 /**
@@ -112,137 +289,581 @@ void analog_write(uint8_t pin, uint8_t value) {
     else if (pin == 3) OCR2B = value;
 }
 
+#define MOTOR_DIR_MASK ((1<<IN1) | (1<<IN2) | (1<<IN3) | (1<<IN4))
+
+volatile uint8_t motor_dir = (1<<IN1) | (1<<IN3); // direção aplicada na próxima troca
+
 /**
- * @brief Enum dos motores disponíveis.
+ * @brief Logo depois de qualquer reset, antes de zerar a RAM: ENA, ENB e a
+ * direção viram saídas em nível baixo (o reset deixa os pinos flutuando).
  */
-typedef enum {LEFT, RIGHT} Motor;
+static void __attribute__((naked, used, section(".init3"))) motors_early(void) {
+  PORTD &= ~((1<<ENA) | (1<<ENB) | MOTOR_DIR_MASK);
+  DDRD |= (1<<ENA) | (1<<ENB) | MOTOR_DIR_MASK;
+}
 
 /**
- * @brief Sentido de rotação: para frente ou para trás.
+ * @brief Desliga a ponte H sem depender do laço: para a atuação, solta ENA e
+ * ENB dos timers e os leva a nível baixo.
  */
-typedef enum {BACKWARDS=0, FORWARD=1} Dir;
+static void motors_off(void) {
+  TIMSK1 &= ~(1<<OCIE1B);
+  TCCR0A &= ~((1<<COM0A1) | (1<<COM0A0));
+  TCCR2A &= ~((1<<COM2B1) | (1<<COM2B0));
+  PORTD &= ~((1<<ENA) | (1<<ENB) | MOTOR_DIR_MASK);
+}
 
 /**
- * @brief Controla um motor no sentido desejado e com PWM.
- * @param motor Motor LEFT ou RIGHT.
- * @param dir Direção FORWARD ou BACKWARDS.
- * @param value Intensidade PWM (0–255).
+ * @brief Watchdog: sem chute desde a última interrupção, para os motores; o
+ * reset vem no período seguinte.
  */
-void motor(Motor motor, Dir dir, uint8_t value);
-void motor(Motor motor, Dir dir, uint8_t value) {
-    switch (motor) {
-    case LEFT:
-        if (dir)  PORTD |=  (1 << IN1);
-        else      PORTD &= ~(1 << IN1);
+ISR(WDT_vect) {
+  if (!wdog_isr()) motors_off();
+}
 
-        if (!dir) PORTD |=  (1 << IN2);
-        else      PORTD &= ~(1 << IN2);
+/**
+ * @brief Aplica a direção quando o novo duty passa a valer.
+ *
+ * No fast PWM é o overflow (BOTTOM); no phase correct é o compare B em 0xFF
+ * (TOP). Só é habilitada quando a direção muda; depois de rodar se desabilita.
+ */
+ISR(TIMER0_OVF_vect) {
+  PORTD = (PORTD & ~MOTOR_DIR_MASK) | motor_dir;
+  TIMSK0 &= ~((1<<TOIE0) | (1<<OCIE0B));
+}
+ISR(TIMER0_COMPB_vect, ISR_ALIASOF(TIMER0_OVF_vect));
+
+/**
+ * @brief Atualiza os dois motores de uma vez.
+ * @param left,right PWM com sinal (-255..255); negativo é para trás.
+ *
+ * OCR0A e OCR2B são duplamente bufferizados e só valem a partir do próximo
+ * BOTTOM (fast) ou TOP (phase correct). Quando a direção muda, a ponte H
+ * recebe as quatro entradas em uma única escrita em PORTD nesse mesmo ponto,
+ * de modo que nunca há IN1 = IN2 (ou IN3 = IN4) com o motor habilitado. Sem
+ * mudança de direção, só os dois OCR são escritos.
+ */
+void motors_set(int16_t left, int16_t right) {
+  uint8_t dir = (left  >= 0 ? (1<<IN1) : (1<<IN2))
+              | (right >= 0 ? (1<<IN3) : (1<<IN4));
+  uint8_t duty_left  = left  >= 0 ? left  : -left;
+  uint8_t duty_right = right >= 0 ? right : -right;
+
+  // Perto do ponto de troca, espera ele passar: um OCR não pode valer um
+  // período antes da direção que o acompanha (no máximo ~24 ciclos + 1 contagem)
+  while (TCNT0 >= pwm_guard_top);
+
+  uint8_t sreg = SREG;
+  cli();
+  OCR0A = duty_left;   // ENA
+  OCR2B = duty_right;  // ENB
+  if (dir != motor_dir) {
+    motor_dir = dir;
+    TIFR0 = (1<<TOV0) | (1<<OCF0B);
+    TIMSK0 |= pwm_commit_ie;
+  }
+  SREG = sreg;
+}
 
-        analog_write(ENA, value);
-        break;
-    case RIGHT:
-        if (dir)  PORTD |=  (1 << IN3);
-        else      PORTD &= ~(1 << IN3);
+/**
+ * @brief PWM com sinal (-255..255) pedido pelo laço e o aplicado pelo COMPB.
+ */
+typedef struct {
+  int16_t left;
+  int16_t right;
+} MotorCmd;
 
-        if (!dir) PORTD |=  (1 << IN4);
-        else      PORTD &= ~(1 << IN4);
+volatile MotorCmd target = {0, 0};
+MotorCmd output = {0, 0};
+uint8_t slew_step = DRIVE_SLEW_STEP;
 
-        analog_write(ENB, value);
-        break;
-    }
+/**
+ * @brief Atuação em fase fixa: sempre ACTUATE_PHASE_US após o início do período.
+ *
+ * Limita a variação por período (slew) antes de escrever nos motores.
+ */
+ISR(TIMER1_COMPB_vect) {
+  HIST_ADD(HIST_MOTOR_LAT, TCNT1 - ACTUATE_OCR);
+  HIST_START(t);
+  output.left  = drive_slew(output.left,  target.left,  slew_step);
+  output.right = drive_slew(output.right, target.right, slew_step);
+
+  motors_set(output.left, output.right);
+  TRACE(TR_MOTOR, abs(output.left));
+  wdog_done(TASK_ACTUATE);
+  HIST_LAP(HIST_MOTOR, t);
+}
+
+/**
+ * @brief Entrega o comando para o próximo instante de atuação.
+ * @param left,right PWM com sinal; negativo é para trás.
+ */
+void schedule_motors(int16_t left, int16_t right) {
+  uint8_t sreg = SREG;
+  cli();
+  target.left = left;
+  target.right = right;
+  SREG = sreg;
+}
+
+/**
+ * @brief Orçamento de tempo do laço, em contagens do Timer1 (0,5us).
+ */
+typedef struct {
+  uint16_t busy_last; // tempo de trabalho do último período
+  uint16_t busy_max;  // maior tempo de trabalho observado
+  uint16_t late;      // períodos em que o comando ficou pronto depois da atuação
+  uint16_t overruns;  // períodos em que o trabalho passou do período inteiro
+  uint32_t win_sum;   // janela da telemetria: soma, máximo e quantidade
+  uint16_t win_max;
+  uint16_t win_periods;
+} LoopBudget;
+
+LoopBudget budget;
+
+/**
+ * @brief Registra quanto do período o laço usou.
+ */
+void budget_update(void) {
+  uint16_t busy = TCNT1;
+
+  if (control_tick) {
+    // O próximo período já começou: o trabalho não coube
+    budget.overruns++;
+    busy = TIMER1_TOP;
+  } else if (busy >= ACTUATE_OCR) {
+    budget.late++;
+  }
+  budget.busy_last = busy;
+  if (busy > budget.busy_max) budget.busy_max = busy;
+  if (busy > budget.win_max) budget.win_max = busy;
+  budget.win_sum += busy;
+  budget.win_periods++;
+}
+
+/**
+ * @brief Registros periódicos da telemetria: tempo do laço e enlace.
+ *
+ * Roda depois do budget_update(), na folga do período; cada registro custa
+ * só a cópia para a fila da serial.
+ */
+void telem_update(void) {
+  static uint16_t late0 = 0, overruns0 = 0, link_ms = 0;
+
+  if (budget.win_periods >= TELEM_LOOP_PERIODS) {
+    TelemLoop r = {
+      budget.win_periods,
+      budget.win_sum / budget.win_periods / 2,
+      budget.win_max / 2,
+      budget.late - late0,
+      budget.overruns - overruns0,
+    };
+    TELEM(TELEM_LOOP, r);
+    late0 = budget.late;
+    overruns0 = budget.overruns;
+    budget.win_sum = 0;
+    budget.win_max = 0;
+    budget.win_periods = 0;
+  }
+
+  uint16_t now = ticks_ms();
+  if ((uint16_t)(now - link_ms) >= TELEM_LINK_MS) {
+    link_ms = now;
+    TelemLink r = {
+      link.accepted, link.duplicated, link.reordered, link.lost, link.recovered,
+#ifdef HOP_ENABLE
+      hop.resyncs,
+#else
+      0,
+#endif
+      link.latency, nrf24_getChannel(),
+    };
+    TELEM(TELEM_LINK, r);
+  }
+}
+
+/**
+ * @brief Espera sem bloquear as interrupções do laço.
+ */
+void wait_ms(uint16_t ms) {
+  uint16_t start = ticks_ms();
+  while ((uint16_t)(ticks_ms() - start) < ms);
+}
+
+/**
+ * @brief Modo bancada: segurando o botão ao ligar, percorre as frequências de PWM.
+ *
+ * Em cada passo os LEDs de vida mostram o índice (em binário) e os dois
+ * motores giram para frente com PWM_BENCH_DUTY por PWM_BENCH_MS, seguidos de
+ * 1s parados, para medir corrente e rotação com um multímetro. No fim volta à
+ * configuração padrão e segue para o jogo.
+ */
+void pwm_bench(void) {
+  static const PwmConfig steps[] = {
+    {PWM_FAST,  1},   {PWM_PHASE, 1},   // 62,5kHz e 31,4kHz
+    {PWM_FAST,  8},   {PWM_PHASE, 8},   // 7,8kHz e 3,9kHz
+    {PWM_FAST,  64},  {PWM_PHASE, 64},  // 977Hz e 490Hz
+    {PWM_FAST,  256}, {PWM_PHASE, 256}, // 244Hz e 123Hz
+  };
+
+  for (uint8_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+    PORTC = i << LED1;
+    pwm_setup(steps[i], steps[i]);
+
+    schedule_motors(PWM_BENCH_DUTY, PWM_BENCH_DUTY);
+    wait_ms(PWM_BENCH_MS);
+    schedule_motors(0, 0);
+    wait_ms(1000);
+  }
+
+  pwm_setup(PWM_LEFT_DEFAULT, PWM_RIGHT_DEFAULT);
 }
 
 /**
- * @brief Reduz a vida e executa a penalidade de dano.
+ * @brief Reduz a vida e, no game over, inicia a penalidade.
  */
 void hit() {
   life <<= 1;
 
-  // Game Over
+  // Game Over: gira por 1s e fica parado os 4s restantes
   if (life == 0b01110000) {
-    PORTB &= ~(1<<0); // Desliga laser
-    // Gira por 1s
-    motor(LEFT,  FORWARD,   200);
-    motor(RIGHT, BACKWARDS, 200);
-    delay_sec(1);
-    motor(LEFT,  FORWARD,   0);
-    motor(RIGHT, BACKWARDS, 0);
-    delay_sec(4); // espera os 4 segundos restantes para contar 5s
-    life = 0b1110;
+    laser_set(LASER_OFF);
+    penalty_ms = 5000;
   }
 }
 
+#ifdef CAPTURE_ENABLE
+typedef struct {
+  TelemCapture head;
+  uint8_t      sample[TELEM_CAPTURE_SAMPLES];
+} CaptureRecord;
+
 /**
- * @brief Laço principal contendo toda a lógica do robô.
+ * @brief Monta o registro de captura do período (chamar com cli, junto da
+ * leitura de ldr_hit, para cada amostra cair no mesmo período do tiro que
+ * ela gerou).
+ * @return bytes de carga do registro.
  */
-void loop() {
+static uint8_t capture_take(CaptureRecord *r) {
+  uint8_t n = cap_count;
+  cap_count = 0;
+  r->head = (TelemCapture){output.left, output.right, life, n};
+  if (n > TELEM_CAPTURE_SAMPLES) {
+    r->head.samples = CAPTURE_OVERFLOW;
+    n = 0;
+  }
+  for (uint8_t i = 0; i < n; i++) r->sample[i] = cap_buf[i];
+  return sizeof(TelemCapture) + n;
+}
+#endif
+
+/**
+ * @brief Etapa 1: leitura do botão e dos tiros detectados no LDR.
+ *
+ * O próprio código (reflexo do laser deste carrinho) não conta.
+ */
+void sense() {
   pressed = IS_PRESSED;
-  if (pressed && !prev) on = !on;
+  if (pressed && !prev) {
+    on = !on;
+#ifdef TRACE_ENABLE
+    trace_dump(&trace);
+#endif
+#ifdef HIST_ENABLE
+    hist_dump();
+#endif
+  }
   prev = pressed;
 
-  bool ldr = (analog_read(LDR) > 800);
+#ifdef CAPTURE_ENABLE
+  CaptureRecord cap;
+#endif
+  cli();
+  uint8_t shooter = ldr_hit;
+  ldr_hit = 0;
+#ifdef CAPTURE_ENABLE
+  uint8_t cap_len = capture_take(&cap);
+#endif
+  sei();
+#ifdef CAPTURE_ENABLE
+  telem_send(TELEM_CAPTURE, ticks_ms(), &cap, cap_len);
+#endif
+
+  if (shooter && shooter - 1 != LASER_PLAYER && !penalty_ms) {
+    hit();
+    TRACE(TR_HIT, shooter - 1);
+#ifdef REPORT_ENABLE
+    hits_by[shooter - 1]++;
+    report_hit = true;
+#endif
 
-  if (ldr && !ldr_prev) hit();
-  ldr_prev = ldr;
+    cli();
+    TelemHit r = {shooter - 1, life, ldr.score, ldr.threshold, LDR_AMBIENT(&ldr), ldr.active};
+    sei();
+    TELEM(TELEM_HIT, r);
+  }
+}
 
-  // Recebendo os dados do controle
-  Controls gamepad = {0, 0, 1, 1}; // desativa tudo caso a recepção falhe
+/**
+ * @brief Etapa 2: recebe o quadro mais recente do controle.
+ */
+void receive() {
   int available = nrf24_available();
   LED(LED2, available);
   
   if (available) {
-    nrf24_read(&gamepad, sizeof(gamepad));
+    Frame frame;
+    uint16_t now = ticks_ms();
+    nrf24_read(&frame, sizeof(frame));
+    TRACE(TR_RX, frame.seq);
+#ifdef CAPTURE_ENABLE
+    telem_send(TELEM_FRAME, now, &frame, sizeof(frame));
+#endif
+#ifdef HOP_ENABLE
+    hop_rx_packet(&hop, now);
+#endif
+    // Duplicado (ACK perdido) ou fora de ordem: repete o último comando
+    if (frame_rx_accept(&link, &frame, now)) {
+      frame_decode(&frame, &last_gamepad);
+      last_cmd_ms = now;
+      if (!boot.first_us) {
+        boot.first_us = timer1_us();
+        TelemBoot r = {boot.warm, boot.channel, boot.radio_us, boot.first_us};
+        TELEM(TELEM_BOOT, r);
+      }
+
+      // Não perde um toque de botão que só estava nos quadros perdidos
+      Controls lost;
+      for (uint8_t k = 1; k <= link.gap && frame_history(&frame, k, &lost); k++) {
+        last_gamepad.sw |= lost.sw;
+        last_gamepad.trigger |= lost.trigger;
+      }
+    }
   }
 
-  // Alterna o laser a cada 1s
-  if (ovf_count >= 1) {
-    ovf_count = 0;
+#ifdef HOP_ENABLE
+  if (hop_rx_poll(&hop, ticks_ms())) nrf24_setChannel(hop_channel(hop.index));
+#endif
+}
 
-    PORTB ^= (1<<0);
+/**
+ * @brief Etapa 3: decide a saída e agenda a atuação.
+ */
+void control() {
+  // Sem comando recente: desativa tudo
+  Controls gamepad = last_gamepad;
+  if ((uint16_t)(ticks_ms() - last_cmd_ms) > CMD_TIMEOUT_MS) {
+    gamepad = (Controls){0, 0, 1, 1};
+  }
+
+  // Penalidade de game over
+  if (penalty_ms) {
+    penalty_ms = penalty_ms > TICK_MS ? penalty_ms - TICK_MS : 0;
+    if (penalty_ms > 4000) schedule_motors(200, -200);
+    else                   schedule_motors(0, 0);
+    if (!penalty_ms) {
+      life = 0b1110;
+      laser_set(LASER_MODE);
+    }
+
+    PORTC = life;
+    return;
   }
 
   // Vida
   PORTC = life;
 
   // Controle do Motor
-  if (gamepad.x < -100) {
-    motor(LEFT, FORWARD, 0);
-  } else {
-    motor(LEFT, gamepad.y > 0 ? FORWARD : BACKWARDS, abs(gamepad.y) * 2);
+  int16_t left, right;
+  drive_mix(gamepad.x, gamepad.y, &left, &right);
+  schedule_motors(left, right);
+}
+
+/**
+ * @brief Um período do laço: sensores, rádio e controle, nessa ordem.
+ *
+ * O laço roda uma vez por interrupção do Timer1; a atuação acontece no COMPB,
+ * em fase fixa, com o comando mais novo que ficou pronto até ali.
+ */
+void loop() {
+  HIST_LAP(HIST_PERIOD, period_start);
+  HIST_START(t);
+  TRACE(TR_LOOP, 0);
+  sense();
+  wdog_done(TASK_SENSE);
+  HIST_LAP(HIST_READ, t);
+  receive();
+  wdog_done(TASK_RECEIVE);
+  HIST_LAP(HIST_RADIO, t);
+  control();
+  wdog_done(TASK_CONTROL);
+  HIST_LAP(HIST_CONTROL, t);
+  TRACE(TR_LOOP_END, 0);
+}
+
+#ifdef REPORT_ENABLE
+/**
+ * @brief Relatório para a estação base, sem segurar o laço.
+ *
+ * Um período tira o rádio da recepção e começa o envio (sem ACK, ~350us
+ * até sair tudo); o primeiro período que vê o TX_DS volta a ouvir. O
+ * controle fica sem receptor por um ou dois períodos a cada REPORT_MS, o
+ * que as retransmissões dele cobrem.
+ */
+void report_poll(void) {
+  static uint8_t seq = 0, flags = REPORT_BOOT;
+  static bool sending = false;
+  static uint16_t last_ms = 0;
+
+  if (sending) {
+    if (!nrf24_txPoll()) return;
+    sending = false;
+    nrf24_startListening();
+    return;
   }
 
-  if (gamepad.x > 100) {
-    motor(RIGHT, FORWARD, 0);
-  } else {
-    motor(RIGHT, gamepad.y > 0 ? FORWARD : BACKWARDS, abs(gamepad.y) * 2);
+  uint16_t now = ticks_ms();
+  if (!report_hit && (uint16_t)(now - last_ms) < REPORT_MS) return;
+
+  CarReport r = {
+    now, link.accepted, link.lost, LASER_PLAYER, seq++,
+    flags | (penalty_ms ? REPORT_PENALTY : 0) | (report_hit ? REPORT_HIT : 0),
+    life, link.latency, RADIO_CHANNEL,
+  };
+  for (uint8_t i = 0; i < REPORT_SHOOTERS; i++) r.hits_by[i] = hits_by[i];
+  nrf24_startWrite(&r, sizeof(r), 1);
+  sending = true;
+  last_ms = now;
+  if (seq == REPORT_BOOT_SEQS) flags = 0;
+  report_hit = false;
+}
+#endif
+
+#ifdef TELEM_ENABLE
+/**
+ * @brief Comandos de um byte vindos do PC pela serial (RX, PD0).
+ *
+ * h envia os histogramas e z os zera (HIST_ENABLE); t envia o rastro
+ * (TRACE_ENABLE). Os envios andam um registro por período.
+ */
+void serial_commands(void) {
+  switch (uart_read()) {
+#ifdef HIST_ENABLE
+  case 'h': hist_dump(); break;
+  case 'z': hist_clear(hist); break;
+#endif
+#ifdef TRACE_ENABLE
+  case 't': trace_dump(&trace); break;
+#endif
   }
 }
+#endif
 
 /**
- * @brief Função principal: inicializa periféricos e roda loop().
+ * @brief Inicializa periféricos, rádio e watchdog (o tools/carreplay chama
+ * esta mesma função no PC antes de repetir a captura).
  */
-int main() {
+void setup() {
+  wdog_boot();
   timer1_setup();
   analog_setup();
+  laser_setup(TICK_MS);
+  laser_set(LASER_MODE);
 
   sei();
 
   // Preferi definir desse jeito pela facilidade
-  DDRB |= 0b00000001;
   DDRC |= 0b00001110;
   DDRD |= 0b01111110;
 
   PORTD |= (1<<7);
 
-  nrf24_begin(9, 10, RF24_SPI_SPEED);
-  nrf24_openReadingPipe(0, addr);
-  nrf24_setChannel(76);
+  // Rádio: depois de um reset com o rádio ainda alimentado, nada é regravado
+  uint32_t t0 = timer1_us();
+  Nrf24Config radio = radio_config;
+  frame_rx_begin(&link);
+#ifdef HOP_ENABLE
+  hop_init(HOP_SEED);
+  hop_rx_begin(&hop);
+  radio.channel = hop_channel(hop.index);
+#endif
+  boot.warm = nrf24_begin_config(9, 10, RF24_SPI_SPEED, &radio);
+  boot.channel = radio.channel;
+#ifdef REPORT_ENABLE
+  static const uint8_t base_addr[5] = {REPORT_ADDR_LSB + LASER_PLAYER, REPORT_ADDR_TAIL};
+  nrf24_setTxAddress(base_addr);
+#endif
   nrf24_startListening();
+  boot.radio_us = timer1_us() - t0;
+
+  PORTD = (PORTD & ~MOTOR_DIR_MASK) | motor_dir;
+  motors_set(0, 0);
 
-  motor(LEFT, FORWARD, 0);
-  motor(RIGHT, FORWARD, 0);
+  // Antes da bancada: os ~48s dela não são tempo de reinício
+  reset_stats.restart_us = timer1_us();
+  if (IS_PRESSED) pwm_bench();
+
+  wdog_start(WDOG_TIMEOUT, TASK_ALL);
+
+#ifdef TELEM_ENABLE
+  uart_begin();
+  static_assert(RESET_CAUSES == sizeof(((TelemReset *)0)->count) / 2);
+  TelemReset r = {.cause = reset_stats.cause, .stalled = reset_stats.stalled, .restart_us = reset_stats.restart_us};
+  for (uint8_t i = 0; i < RESET_CAUSES; i++) r.count[i] = reset_stats.count[i];
+  TELEM(TELEM_RESET, r);
+#endif
 
-  while (1) loop();
+#ifdef HIST_ENABLE
+  period_start = hist_clock();
+#endif
+
+#ifdef CAPTURE_ENABLE
+  // A captura começa com o detector zerado, o mesmo estado em que o replay começa
+  cli();
+  ldr_begin(&ldr);
+  ldr_hit = 0;
+  cap_count = 0;
+  sei();
+#endif
+}
+
+/**
+ * @brief Função principal: inicializa e roda loop() uma vez por período.
+ */
+int main() {
+  setup();
+
+  // Entre um período e outro a CPU fica em idle: as conversões do LDR (que
+  // rodam o tempo todo) pegam menos ruído digital e os timers seguem normais
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  while (1) {
+    cli();
+    while (!control_tick) {
+      sleep_enable();
+      sei();
+      sleep_cpu();
+      sleep_disable();
+      cli();
+    }
+    control_tick = 0;
+    sei();
+
+    loop();
+    budget_update();
+    telem_update();
+#ifdef REPORT_ENABLE
+    report_poll();
+#endif
+#ifdef TELEM_ENABLE
+    serial_commands();
+#endif
+#ifdef TRACE_ENABLE
+    trace_poll(&trace, ticks_ms());
+#endif
+#ifdef HIST_ENABLE
+    hist_poll(hist, ticks_ms());
+#endif
+  }
 
   return 0;
 }
@@ -0,0 +1,58 @@
+#include <avr/pgmspace.h>
+#include "drive.h"
+
+/*
+ Curva |comando| (0..127) -> PWM (0..255), em flash.
+
+ Gerada com pwm = 60 + 195 * (0,7*t + 0,3*t^3), t = v/127, e 0 para v = 0:
+ começa acima do PWM em que os motores vencem o atrito (~60) e é mais suave
+ perto do centro, onde a direção precisa de precisão.
+*/
+static const uint8_t drive_curve[128] PROGMEM = {
+    0,  61,  62,  63,  64,  65,  66,  68,  69,  70,  71,  72,  73,  74,  75,  76,
+   77,  78,  80,  81,  82,  83,  84,  85,  86,  87,  88,  90,  91,  92,  93,  94,
+   95,  96,  98,  99, 100, 101, 102, 104, 105, 106, 107, 108, 110, 111, 112, 113,
+  115, 116, 117, 119, 120, 121, 123, 124, 125, 127, 128, 129, 131, 132, 133, 135,
+  136, 138, 139, 141, 142, 144, 145, 147, 148, 150, 151, 153, 154, 156, 157, 159,
+  161, 162, 164, 166, 167, 169, 171, 172, 174, 176, 178, 179, 181, 183, 185, 187,
+  188, 190, 192, 194, 196, 198, 200, 202, 204, 206, 208, 210, 212, 214, 216, 218,
+  221, 223, 225, 227, 229, 231, 234, 236, 238, 241, 243, 245, 248, 250, 253, 255,
+};
+
+/**
+ * @brief Aplica a curva a um comando com sinal.
+ * @param v comando de -254 a 254 (saturado em ±127).
+ * @return PWM com sinal, de -255 a 255.
+ */
+static int16_t curve(int16_t v) {
+  if (v > 127)  v = 127;
+  if (v < -127) v = -127;
+  uint8_t pwm = pgm_read_byte(&drive_curve[v < 0 ? -v : v]);
+  return v < 0 ? -(int16_t)pwm : pwm;
+}
+
+/**
+ * @brief Mistura de tração diferencial (arcade): y acelera, x vira.
+ *
+ * x > 0 vira para a direita (roda esquerda mais rápida). Com y = 0 o carrinho
+ * gira no próprio eixo. Custo fixo: duas somas e duas leituras da tabela.
+ *
+ * @param left,right PWM com sinal (-255..255); negativo é para trás.
+ */
+void drive_mix(int8_t x, int8_t y, int16_t *left, int16_t *right) {
+  *left  = curve((int16_t)y + x);
+  *right = curve((int16_t)y - x);
+}
+
+/**
+ * @brief Aproxima current de target em no máximo step por chamada.
+ *
+ * Chamado uma vez por período do laço de controle; uma inversão de sentido
+ * passa por zero em rampa em vez de inverter a ponte H de uma vez.
+ */
+int16_t drive_slew(int16_t current, int16_t target, uint8_t step) {
+  if (step == 0) return target;
+  if (target > current + step) return current + step;
+  if (target < current - step) return current - step;
+  return target;
+}
@@ -0,0 +1,11 @@
+#ifndef DRIVE_H
+#define DRIVE_H
+
+#include <stdint.h>
+
+#define DRIVE_SLEW_STEP 4 // Máxima variação de PWM por período do laço (0 = sem limite)
+
+void    drive_mix(int8_t x, int8_t y, int16_t *left, int16_t *right);
+int16_t drive_slew(int16_t current, int16_t target, uint8_t step);
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef HIST_H
+#define HIST_H
+
+#include <stdint.h>
+#include <assert.h>
+
+/*
+ Histogramas de tempo em escala log2, em RAM: cada amostra é uma diferença
+ de capturas do Timer1 (contagens de 0,5us) e cai no bucket do seu número de
+ bits, então 16 contadores cobrem de 0,5us a 16ms com erro relativo fixo
+ (fator 2), e registrar custa ~30 ciclos, também dentro de interrupções.
+
+ Bucket 0: amostras iguais a 0; bucket k (1..15): [2^(k-1), 2^k) contagens;
+ o último também leva o que passar de 2^15 (16ms). Os contadores saturam em
+ 0xFFFF em vez de dar a volta.
+
+ Cada firmware escolhe o que mede (HistId) e quem escreve cada histograma
+ é sempre o mesmo contexto (o laço ou uma interrupção); o envio copia com as
+ interrupções desligadas. Sem HIST_ENABLE o firmware não cria os Hist nem
+ chama nada daqui, e o hist.o fica fora da ligação (Makefile da raiz).
+*/
+
+/*** CONFIGURAÇÃO ***/
+#define HIST_BUCKETS 16
+
+typedef enum {
+  HIST_PERIOD,     // início a início do laço (carrinho) ou do envio (controle)
+  HIST_READ,       // sense() no carrinho; as duas leituras do ADC no controle
+  HIST_RADIO,      // receive() no carrinho; envio do txbox no controle
+  HIST_CONTROL,    // control() (carrinho)
+  HIST_MOTOR,      // ISR do COMPB inteira: slew e motors_set() (carrinho)
+  HIST_TICK_LAT,   // compare do COMPA até a primeira instrução da ISR
+  HIST_MOTOR_LAT,  // compare do COMPB até a primeira instrução da ISR (carrinho)
+  HIST_IDS
+} HistId;
+
+typedef struct {
+  uint16_t count[HIST_BUCKETS];
+  uint16_t max;    // maior amostra, em contagens
+} Hist;
+
+/**
+ * @brief Bucket de uma amostra: o número de bits dela, limitado ao último.
+ */
+static inline uint8_t hist_bucket(uint16_t v) {
+  uint8_t b = 0;
+  if (v >= 256) { b = 8; v >>= 8; }
+  if (v >= 16)  { b += 4; v >>= 4; }
+  if (v >= 4)   { b += 2; v >>= 2; }
+  if (v >= 2)   { b += 1; v >>= 1; }
+  b += v;
+  return b < HIST_BUCKETS ? b : HIST_BUCKETS - 1;
+}
+
+static inline void hist_add(Hist *h, uint16_t v) {
+  uint8_t b = hist_bucket(v);
+  if (h->count[b] != 0xFFFF) h->count[b]++;
+  if (v > h->max) h->max = v;
+}
+
+#ifdef __AVR__
+uint16_t hist_clock(void); // Timer1 em contagens desde o boot (16 bits), definida em cada firmware
+
+/**
+ * @brief Registra o tempo desde *since e passa a contar do agora.
+ */
+static inline void hist_lap(Hist *h, uint16_t *since) {
+  uint16_t now = hist_clock();
+  hist_add(h, now - *since);
+  *since = now;
+}
+
+void    hist_clear(Hist *set);
+void    hist_dump(void);
+uint8_t hist_poll(Hist *set, uint16_t now);
+#endif
+
+#endif
@@ -0,0 +1,164 @@
+#include "hop.h"
+
+/*
+ Salto de frequência com sequência pseudo-aleatória compartilhada.
+
+ O controle envia a cada HOP_PERIOD_MS e troca de canal a cada HOP_SLOTS
+ envios, sempre alinhado à sua grade de tempo: o primeiro envio de cada canal
+ sai logo depois do salto. O carrinho não recebe a fase explicitamente; ele a
+ reconstrói pelos instantes de chegada dos pacotes:
+
+ - HOP_SEARCH: fica parado em um canal até ouvir uma rajada de pacotes. Quando
+   a rajada termina (nenhum pacote em 1,5 período), o controle saltou um
+   período depois do último pacote ouvido, mas só se o último foi o slot
+   HOP_SLOTS-1: a rajada precisa ir do primeiro ao último slot, senão um
+   pacote perdido na ponta põe a fase um slot inteiro fora, e o arredondamento
+   do HOP_TRACK não corrige isso. Rajada incompleta (ouviu do meio, perdeu uma
+   ponta ou um pacote no meio) fica para a próxima volta da sequência neste
+   canal (HOP_LEN canais depois).
+ - HOP_TRACK: salta meio período antes do próximo canal começar e, a cada
+   pacote, corrige a fase arredondando a chegada para o slot mais próximo.
+   Após HOP_RESYNC canais seguidos sem pacote, volta a procurar.
+*/
+
+static uint8_t sequence[HOP_LEN];
+
+/**
+ * @brief Gerador xorshift de 16 bits (o mesmo nos dois firmwares).
+ */
+static uint16_t xorshift16(uint16_t *s) {
+  uint16_t x = *s;
+  x ^= x << 7;
+  x ^= x >> 9;
+  x ^= x << 8;
+  *s = x;
+  return x;
+}
+
+/**
+ * @brief Gera a sequência de canais a partir da semente.
+ *
+ * Os canais não se repetem e dois canais seguidos ficam a pelo menos
+ * HOP_MIN_STEP MHz de distância, para que uma interferência estreita não
+ * derrube dois saltos em sequência.
+ */
+void hop_init(uint16_t seed) {
+  uint8_t used[(HOP_CH_LAST + 8) / 8] = {0};
+  uint8_t prev = 0xFF;
+  uint16_t s = seed ? seed : 1;
+
+  for (uint8_t i = 0; i < HOP_LEN; i++) {
+    uint8_t ch;
+    for (;;) {
+      ch = HOP_CH_FIRST + xorshift16(&s) % (HOP_CH_LAST - HOP_CH_FIRST + 1);
+      if (used[ch >> 3] & (1 << (ch & 7))) continue;
+      if (prev != 0xFF && (ch > prev ? ch - prev : prev - ch) < HOP_MIN_STEP) continue;
+      break;
+    }
+    used[ch >> 3] |= (1 << (ch & 7));
+    sequence[i] = ch;
+    prev = ch;
+  }
+}
+
+/**
+ * @brief Canal de uma posição da sequência.
+ */
+uint8_t hop_channel(uint8_t index) {
+  return sequence[index % HOP_LEN];
+}
+
+/**
+ * @brief Inicia o transmissor no primeiro canal.
+ */
+void hop_tx_begin(HopTx *h, uint16_t now) {
+  h->index = 0;
+  h->start = now;
+}
+
+/**
+ * @brief Avança a sequência conforme o relógio.
+ * @return 1 se o canal mudou.
+ *
+ * Se o laço atrasou mais de um canal (ex.: nrf24_write() esgotou o tempo),
+ * pula os canais perdidos para continuar alinhado com o carrinho.
+ */
+uint8_t hop_tx_poll(HopTx *h, uint16_t now) {
+  uint8_t changed = 0;
+  while ((uint16_t)(now - h->start) >= HOP_DWELL_MS) {
+    h->start += HOP_DWELL_MS;
+    h->index = (h->index + 1) % HOP_LEN;
+    changed = 1;
+  }
+  return changed;
+}
+
+/**
+ * @brief Inicia o receptor procurando no primeiro canal.
+ */
+void hop_rx_begin(HopRx *h) {
+  h->index = 0;
+  h->state = HOP_SEARCH;
+  h->heard = 0;
+  h->missed = 0;
+  h->start = 0;
+  h->first_rx = 0;
+  h->last_rx = 0;
+  h->resyncs = 0;
+}
+
+/**
+ * @brief Informa que um pacote chegou no canal atual.
+ */
+void hop_rx_packet(HopRx *h, uint16_t now) {
+  if (h->state == HOP_SEARCH &&
+      (!h->heard || (uint16_t)(now - h->last_rx) >= HOP_PERIOD_MS + HOP_PERIOD_MS / 2))
+    h->first_rx = now;  // começo de uma rajada
+  h->heard = 1;
+  h->last_rx = now;
+
+  if (h->state == HOP_TRACK) {
+    // Corrige a fase: o pacote é do slot mais próximo do esperado
+    int16_t offset = (int16_t)(now - h->start) + HOP_PERIOD_MS / 2;
+    uint8_t slot = offset < 0 ? 0 : offset / HOP_PERIOD_MS;
+    if (slot >= HOP_SLOTS) slot = HOP_SLOTS - 1;
+    h->start = now - slot * HOP_PERIOD_MS;
+  }
+}
+
+/**
+ * @brief Decide quando o receptor deve saltar.
+ * @return 1 se o canal mudou.
+ */
+uint8_t hop_rx_poll(HopRx *h, uint16_t now) {
+  if (h->state == HOP_SEARCH) {
+    // Fim da rajada: o controle saltou um período após o último pacote
+    if (!h->heard || (uint16_t)(now - h->last_rx) < HOP_PERIOD_MS + HOP_PERIOD_MS / 2)
+      return 0;
+    if ((uint16_t)(h->last_rx - h->first_rx) < (HOP_SLOTS - 1) * HOP_PERIOD_MS - HOP_PERIOD_MS / 2) {
+      h->heard = 0;  // rajada incompleta: espera a próxima neste canal
+      return 0;
+    }
+
+    h->start = h->last_rx + HOP_PERIOD_MS;
+    h->state = HOP_TRACK;
+    h->missed = 0;
+  } else {
+    // Salta no meio do intervalo entre o último slot e o próximo canal
+    // (o início do canal seguinte fica no futuro logo após o salto)
+    if ((int16_t)(now - h->start) < HOP_DWELL_MS - HOP_PERIOD_MS / 2)
+      return 0;
+
+    h->start += HOP_DWELL_MS;
+    h->missed = h->heard ? 0 : h->missed + 1;
+    if (h->missed >= HOP_RESYNC) {
+      // Perdeu a fase: estaciona no próximo canal até ouvir o controle
+      h->state = HOP_SEARCH;
+      h->resyncs++;
+    }
+  }
+
+  h->heard = 0;
+  h->index = (h->index + 1) % HOP_LEN;
+  return 1;
+}
@@ -0,0 +1,85 @@
+#include <assert.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "laser.h"
+
+#define LASER 0 // PB0
+
+static_assert(LASER_PLAYER < LASER_PLAYERS);
+static_assert(LASER_CODE_BITS <= 16);
+
+static const uint16_t laser_codes[LASER_PLAYERS] = LASER_CODES;
+
+/**
+ * @brief Padrão que a interrupção do Timer1 percorre, bit 0 primeiro.
+ */
+typedef struct {
+  uint16_t word;
+  uint8_t  len;   // bits no padrão
+  uint8_t  bit;   // bit atual
+  uint16_t chip;  // ticks por bit
+  uint16_t left;  // ticks até o próximo bit
+} LaserPattern;
+
+static volatile LaserPattern laser;
+static uint8_t laser_tick_ms = 1;
+
+/**
+ * @brief Configura o pino do laser, apagado.
+ * @param tick_ms Intervalo entre chamadas de laser_tick().
+ */
+void laser_setup(uint8_t tick_ms) {
+  laser_tick_ms = tick_ms;
+  DDRB |= (1<<LASER);
+  laser_set(LASER_OFF);
+}
+
+/**
+ * @brief Troca o padrão; o primeiro bit sai na hora.
+ */
+void laser_set(uint8_t mode) {
+  LaserPattern p = {0, 1, 0, 1, 1};
+
+  switch (mode) {
+  case LASER_ON:
+    p.word = 1;
+    break;
+  case LASER_BLINK:
+    p.word = 0b01;
+    p.len = 2;
+    p.chip = LASER_BLINK_MS / laser_tick_ms;
+    break;
+  case LASER_CODED:
+    p.word = laser_codes[LASER_PLAYER];
+    p.len = LASER_CODE_BITS;
+    p.chip = LASER_CHIP_MS / laser_tick_ms;
+    break;
+  }
+  if (p.chip == 0) p.chip = 1;
+  p.left = p.chip;
+
+  uint8_t sreg = SREG;
+  cli();
+  laser = p;
+  if (p.word & 1) PORTB |= (1<<LASER);
+  else            PORTB &= ~(1<<LASER);
+  SREG = sreg;
+}
+
+/**
+ * @brief Avança o padrão; chamada pela interrupção do relógio do laço.
+ *
+ * PB0 não tem saída de comparação de timer, então o padrão sai daqui: no pior
+ * caso ~30 ciclos por tick, sem nenhum trabalho no laço principal.
+ */
+void laser_tick(void) {
+  if (--laser.left) return;
+  laser.left = laser.chip;
+
+  uint8_t bit = laser.bit + 1;
+  if (bit >= laser.len) bit = 0;
+  laser.bit = bit;
+
+  if ((laser.word >> bit) & 1) PORTB |= (1<<LASER);
+  else                         PORTB &= ~(1<<LASER);
+}
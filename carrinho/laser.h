@@ -0,0 +1,38 @@
+#ifndef LASER_H
+#define LASER_H
+
+#include <stdint.h>
+
+/*** CONFIGURAÇÃO ***/
+#define LASER_MODE    LASER_CODED // Modo no início do jogo e depois da penalidade
+#define LASER_PLAYER  0           // Código deste carrinho em laser_codes[]
+#define LASER_CHIP_MS 20          // Duração de cada chip do código (>= tempo de resposta do LDR)
+#define LASER_BLINK_MS 1000       // Meio período do LASER_BLINK
+
+#define LASER_PLAYERS   4
+#define LASER_CODE_BITS 16
+
+/*
+ Códigos de 16 chips, 8 acesos (o brilho médio não depende do jogador) e no
+ máximo 4 chips iguais seguidos. Em ±1, a autocorrelação cíclica fora do pico
+ é no máximo 4 (de 16). Foram escolhidos pela correlação cruzada depois do
+ atraso do LDR (primeira ordem, constante de tempo de até 2 chips): no máximo
+ 0,55 do pico, contra 0,5 sem atraso. O bit 0 é o primeiro a sair.
+*/
+#define LASER_CODES {0x0D67, 0x1B2D, 0x24AF, 0x11DB}
+
+/**
+ * @brief O que o laser (PB0) emite.
+ *
+ * LASER_BLINK: aceso e apagado por LASER_BLINK_MS, como no jogo original
+ * (o detector do LDR, ldr.h, não reconhece esse padrão).
+ * LASER_CODED: repete sem parar o código de LASER_PLAYER, um bit por
+ * LASER_CHIP_MS, para o receptor saber quem atirou.
+ */
+typedef enum {LASER_OFF, LASER_ON, LASER_BLINK, LASER_CODED} LaserMode;
+
+void laser_setup(uint8_t tick_ms);
+void laser_set(uint8_t mode);
+void laser_tick(void);
+
+#endif
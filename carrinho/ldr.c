@@ -0,0 +1,148 @@
+#include "ldr.h"
+
+static const uint16_t codes[LASER_PLAYERS] = LASER_CODES;
+
+void ldr_begin(LdrDetector *d) {
+  *d = (LdrDetector){0};
+  d->threshold = LDR_HIT_MIN;
+}
+
+/**
+ * @brief Correlação dos últimos LASER_CODE_BITS chips com um código.
+ *
+ * O chip mais novo corresponde ao último bit do código: o pico aparece uma vez
+ * por repetição, quando o código inteiro acabou de passar. Como os códigos são
+ * balanceados, a luz ambiente (constante) se cancela.
+ */
+static int16_t correlate(const LdrDetector *d, uint16_t code) {
+  int16_t sum = 0;
+  uint8_t k = d->head;
+  for (int8_t b = LASER_CODE_BITS - 1; b >= 0; b--) {
+    if ((code >> b) & 1) sum += d->ring[k];
+    else                 sum -= d->ring[k];
+    k = (k - LDR_SUBBINS) & (LDR_RING - 1);
+  }
+  return sum;
+}
+
+/**
+ * @brief Atualiza a média e o desvio do correlador e recalcula o limiar.
+ *
+ * Só entram decisões abaixo do limiar e sem ninguém na mira, para que um
+ * laser (e a correlação cruzada dele com os outros códigos) não suba o
+ * próprio limiar; cada desvio entra limitado ao limiar atual, para que uma
+ * sombra isolada não o dispare. Assim o limiar acompanha o ambiente: lâmpadas,
+ * sombras e o movimento do carrinho aumentam o desvio do correlador mesmo com
+ * os códigos balanceados.
+ */
+static void noise_update(LdrDetector *d, int16_t score) {
+  int32_t mean = d->mean >> LDR_NOISE_SHIFT;
+  int32_t diff = score - mean;
+  d->mean += diff;
+  if (diff < 0) diff = -diff;
+  if (diff > d->threshold) diff = d->threshold;
+  d->dev += diff - (d->dev >> LDR_NOISE_SHIFT);
+
+  int32_t t = mean + LDR_NOISE_K * (d->dev >> LDR_NOISE_SHIFT);
+  if (t < (int32_t)LDR_HIT_MIN) t = LDR_HIT_MIN;
+  if (t > INT16_MAX) t = INT16_MAX;
+  d->threshold = t;
+}
+
+/**
+ * @brief Escolhe o código mais forte e decide se é um tiro novo.
+ *
+ * Um tiro novo precisa passar do limiar adaptativo; depois disso o jogador
+ * continua na mira enquanto o código passar da metade dele (histerese), e sai
+ * depois de LDR_HOLD_SUBS sem isso.
+ *
+ * Só vale o código que passa de 3/4 do maior pico dos dois últimos períodos:
+ * a correlação cruzada fica abaixo de 0,55 do pico mesmo com o atraso do LDR,
+ * então um laser forte não vira tiro de outro jogador. Um segundo atirador bem
+ * mais fraco ao mesmo tempo fica mascarado até o primeiro sair da mira.
+ *
+ * O tiro só é confirmado quando o pico se repete um código depois: degraus de
+ * luz (alguém passando na frente de uma lâmpada) dão um pico isolado.
+ */
+static uint8_t decide(LdrDetector *d) {
+  uint8_t best = 0;
+  for (uint8_t j = 1; j < LASER_PLAYERS; j++)
+    if (d->corr[j] > d->corr[best]) best = j;
+  int16_t score = d->corr[best];
+
+  // Máximo dos dois últimos períodos do código, sem decaimento
+  if (d->ticks % LDR_PERIOD_SUBS == 0) {
+    d->peak_prev = d->peak;
+    d->peak = 0;
+  }
+  if (score > d->peak) d->peak = score;
+  int16_t ref = d->peak > d->peak_prev ? d->peak : d->peak_prev;
+
+  for (uint8_t j = 0; j < LASER_PLAYERS; j++)
+    if ((uint16_t)(d->ticks - d->last_seen[j]) > LDR_HOLD_SUBS) d->active &= ~(1 << j);
+
+  // Até a janela encher, a correlação ainda vê os zeros iniciais
+  if (d->warm < LDR_RING) return 0;
+
+  if (!d->active && score < d->threshold) noise_update(d, score);
+  if (score < d->threshold >> 1 || score < ref - (ref >> 2)) return 0;
+
+  // Com o LDR lento, o pico ocupa vários sub-intervalos seguidos; conta o
+  // início de cada um
+  uint16_t gap = d->ticks - d->last_seen[best];
+  d->last_seen[best] = d->ticks;
+  if (gap <= 2 * LDR_SUBBINS) return 0;
+
+  uint16_t since = d->ticks - d->cluster[best];
+  d->cluster[best] = d->ticks;
+  if (d->active & (1 << best)) return 0;
+  if (score < d->threshold) return 0;
+  if (since < LDR_PERIOD_SUBS - LDR_SUBBINS || since > LDR_PERIOD_SUBS + LDR_SUBBINS) return 0;
+
+  d->active |= 1 << best;
+  d->score = score;
+  return best + 1;
+}
+
+/**
+ * @brief Processa uma amostra do LDR (ADC de 8 bits, mais claro = maior).
+ * @return 0, ou 1 + o jogador quando um tiro novo é detectado.
+ *
+ * O trabalho é dividido entre as amostras para caber em um orçamento fixo:
+ * a amostra que fecha o sub-intervalo atualiza os chips, as LASER_PLAYERS
+ * seguintes correlacionam um código cada e a próxima decide. No pior caso
+ * é uma correlação de 16 chips (~200 ciclos) por amostra, de 1664 ciclos
+ * disponíveis entre conversões.
+ */
+uint8_t ldr_sample(LdrDetector *d, uint8_t value) {
+  d->acc += value;
+  uint8_t result = 0;
+
+  if (d->step) {
+    if (d->step <= LASER_PLAYERS) {
+      d->corr[d->step - 1] = correlate(d, codes[d->step - 1]);
+      d->step++;
+    } else {
+      result = decide(d);
+      d->step = 0;
+    }
+  }
+
+  if (++d->count < LDR_SUB_SAMPLES) return result;
+
+  uint16_t sub = d->acc >> LDR_SUB_SHIFT;
+  if (!d->warm) d->ambient = sub << LDR_LEVEL_SHIFT;
+  if (d->warm < LDR_RING) d->warm++;
+  d->ambient += sub - (d->ambient >> LDR_LEVEL_SHIFT);
+
+  uint8_t slot = d->ticks % LDR_SUBBINS;
+  d->chip += sub - d->sub[slot];
+  d->sub[slot] = sub;
+  d->head = (d->head + 1) & (LDR_RING - 1);
+  d->ring[d->head] = d->chip;
+  d->ticks++;
+  d->acc = 0;
+  d->count = 0;
+  d->step = 1;
+  return result;
+}
@@ -0,0 +1,79 @@
+#ifndef LDR_H
+#define LDR_H
+
+#include <stdint.h>
+#include <assert.h>
+#include "laser.h"
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+/*** CONFIGURAÇÃO ***/
+#define LDR_HIT_CONTRAST 12 // Diferença mínima aceso/apagado no LDR (ADC de 8 bits)
+#define LDR_SUBBINS      4  // Fases testadas por chip do código
+#define LDR_NOISE_K      3  // Limiar = média + LDR_NOISE_K * desvio médio do correlador
+#define LDR_NOISE_SHIFT  8  // Média móvel do correlador: 2^8 sub-intervalos (~1,3s)
+#define LDR_LEVEL_SHIFT  6  // Média móvel da luz ambiente: 2^6 sub-intervalos (~0,3s)
+
+/*
+ O ADC roda livre com prescaler 128 (13 ciclos de ADC por conversão) e cada
+ amostra vai para ldr_sample() pela interrupção. As amostras são somadas em
+ sub-intervalos de 1/LDR_SUBBINS chip; a cada sub-intervalo o correlador
+ compara os últimos 16 chips com o código de cada jogador.
+
+ Com 9615 amostras/s e chips de 20ms são 48 amostras por sub-intervalo, ou
+ 19,97ms por chip: o desvio de 0,16% em relação ao laser é de 1/40 de chip ao
+ longo de um código inteiro.
+*/
+#define LDR_SAMPLE_HZ   (F_CPU / 128 / 13)
+#define LDR_SUB_SAMPLES ((LDR_SAMPLE_HZ * LASER_CHIP_MS + 500 * LDR_SUBBINS) / (1000 * LDR_SUBBINS))
+#define LDR_SUB_SHIFT   4
+#define LDR_RING        64 // potência de 2, pelo menos (LASER_CODE_BITS-1)*LDR_SUBBINS+1
+#define LDR_PERIOD_SUBS (LASER_CODE_BITS * LDR_SUBBINS) // sub-intervalos por repetição do código
+#define LDR_HOLD_SUBS   (2 * LDR_PERIOD_SUBS)             // sem pico por 2 códigos: saiu da mira
+
+// Correlação de um código balanceado para cada passo de diferença no ADC
+#define LDR_PEAK_PER_STEP (LASER_CODE_BITS / 2 * LDR_SUBBINS * LDR_SUB_SAMPLES >> LDR_SUB_SHIFT)
+#define LDR_HIT_MIN       (LDR_HIT_CONTRAST * LDR_PEAK_PER_STEP) // piso do limiar adaptativo
+
+static_assert(LDR_HIT_MIN <= 32767);
+static_assert(LDR_SUB_SAMPLES >= LASER_PLAYERS + 2);      // uma etapa do correlador por amostra
+static_assert(LDR_RING >= (LASER_CODE_BITS - 1) * LDR_SUBBINS + 1);
+static_assert((LDR_RING & (LDR_RING - 1)) == 0);
+static_assert(LASER_CODE_BITS / 2 * LDR_SUBBINS * (255L * LDR_SUB_SAMPLES >> LDR_SUB_SHIFT) <= 32767);
+
+/**
+ * @brief Detector de tiros codificados no LDR.
+ */
+typedef struct {
+  uint16_t acc;                   // soma das amostras do sub-intervalo atual
+  uint8_t  count;                 // amostras no sub-intervalo atual
+  uint8_t  step;                  // etapa do correlador (0 = ocioso)
+  uint8_t  head;                  // último sub-intervalo em ring
+  uint16_t chip;                  // soma dos últimos LDR_SUBBINS sub-intervalos
+  uint16_t ring[LDR_RING];        // soma de um chip terminando em cada sub-intervalo
+  uint16_t sub[LDR_SUBBINS];      // últimos sub-intervalos
+  int16_t  corr[LASER_PLAYERS];   // correlação de cada código no último sub-intervalo
+  int16_t  peak;                  // maior correlação no período atual do código
+  int16_t  peak_prev;             // e no anterior
+  int16_t  score;                 // correlação do último tiro detectado
+  int32_t  mean;                  // média móvel da correlação sem tiro, x2^LDR_NOISE_SHIFT
+  int32_t  dev;                   // desvio médio absoluto em torno da média, idem
+  int16_t  threshold;             // limiar de entrada (o de saída é a metade)
+  uint16_t ambient;               // média móvel de um sub-intervalo, x2^LDR_LEVEL_SHIFT
+  uint16_t ticks;                 // sub-intervalos desde ldr_begin() (dá a volta em ~5min)
+  uint8_t  warm;                  // sub-intervalos até a janela encher (satura em LDR_RING)
+  uint16_t last_seen[LASER_PLAYERS]; // último sub-intervalo acima do limiar
+  uint16_t cluster[LASER_PLAYERS];   // início do último pico
+  uint8_t  active;                // bit por jogador: mira em cima agora
+} LdrDetector;
+
+// Luz ambiente como média de uma amostra do ADC (0..255)
+#define LDR_AMBIENT(d) ((uint8_t)((((d)->ambient >> LDR_LEVEL_SHIFT) << LDR_SUB_SHIFT) / LDR_SUB_SAMPLES))
+static_assert(((255UL * LDR_SUB_SAMPLES >> LDR_SUB_SHIFT) << LDR_LEVEL_SHIFT) <= 65535);
+
+void    ldr_begin(LdrDetector *d);
+uint8_t ldr_sample(LdrDetector *d, uint8_t value);
+
+#endif
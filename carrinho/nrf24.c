@@ -0,0 +1,367 @@
+#include <string.h>
+#include "nrf24_avr.h"
+#include "nrf24_hal.h"
+#include "nRF24L01.h"
+#include "RF24_config.h"
+
+/*
+ Register and payload logic of the driver. The radio is only reached through
+ nrf24_hal.h, so this file builds unchanged for the AVR (nrf24_avr.c) and for
+ Linux (tools/nrf24_linux.c, tools/nrf24_mock.c).
+*/
+
+static uint8_t payload_size = 32;
+static uint8_t addr_width = 5;
+static uint8_t dynamic_payloads = 1;
+static uint8_t rf_ch = 0xFF; // shadow of RF_CH (0xFF = unknown)
+static uint8_t prim_rx = 1;   // shadow of PRIM_RX (1 until the first stopListening)
+
+/* Low-level register access: each call is one CSN-framed transaction */
+static uint8_t status_reg;
+static void write_reg(uint8_t reg, const uint8_t* buf, uint8_t len) {
+    uint8_t tx[6];
+    tx[0] = W_REGISTER | (reg & REGISTER_MASK);
+    memcpy(tx + 1, buf, len);
+    Nrf24Xfer x = {tx, len + 1};
+    nrf24_hal_xfer(&x, 1);
+    status_reg = tx[0];
+}
+static uint8_t read_reg(uint8_t reg) {
+    uint8_t rx[2] = {R_REGISTER | (reg & REGISTER_MASK), 0xff};
+    Nrf24Xfer x = {rx, 2};
+    nrf24_hal_xfer(&x, 1);
+    status_reg = rx[0];
+    return rx[1];
+}
+static void read_reg_buf(uint8_t reg, uint8_t* buf, uint8_t len) {
+    uint8_t rx[6];
+    rx[0] = R_REGISTER | (reg & REGISTER_MASK);
+    memset(rx + 1, 0xff, len);
+    Nrf24Xfer x = {rx, len + 1};
+    nrf24_hal_xfer(&x, 1);
+    status_reg = rx[0];
+    memcpy(buf, rx + 1, len);
+}
+static uint8_t command(uint8_t cmd) {
+    Nrf24Xfer x = {&cmd, 1};
+    nrf24_hal_xfer(&x, 1);
+    return status_reg = cmd;
+}
+
+/* payload ops: bytes clocked after the command (static size pads with filler) */
+static uint8_t payload_len(uint8_t len) {
+    if (!dynamic_payloads) return payload_size;
+    return len > 32 ? 32 : len;
+}
+
+static void write_payload(const void *buf, uint8_t len, uint8_t cmd) {
+    uint8_t tx[33] = {cmd};
+    uint8_t n = payload_len(len);
+    memcpy(tx + 1, buf, len < n ? len : n);
+    Nrf24Xfer x = {tx, n + 1};
+    nrf24_hal_xfer(&x, 1);
+    status_reg = tx[0];
+}
+
+/* API implementation */
+
+void nrf24_begin(uint8_t ce_pin, uint8_t csn_pin, uint32_t spi_speed_hz) {
+    nrf24_hal_begin(ce_pin, csn_pin, spi_speed_hz);
+    rf_ch = 0xFF;
+    prim_rx = 1;
+
+    // Basic reset/config
+    nrf24_hal_delay_us(RF24_POWERUP_DELAY);
+    // power up, CRC 1 byte, PRIM_RX=0
+    uint8_t cfg = (1<<PWR_UP) | (1<<EN_CRC);
+    write_reg(NRF_CONFIG, &cfg, 1);
+    nrf24_hal_delay_us(5000);
+    // default payload size
+    nrf24_setPayloadSize(payload_size);
+    // enable auto ack on pipe0
+    uint8_t en_aa = 0x01;
+    write_reg(EN_AA, &en_aa, 1);
+    // enable pipe0
+    uint8_t en_rx = 0x01;
+    write_reg(EN_RXADDR, &en_rx, 1);
+}
+
+/* Write a register only when it differs; returns 1 if it was written */
+static uint8_t sync_reg(uint8_t reg, uint8_t value) {
+    if (read_reg(reg) == value) return 0;
+    write_reg(reg, &value, 1);
+    return 1;
+}
+
+static uint8_t sync_addr(uint8_t reg, const uint8_t *address) {
+    uint8_t cur[5];
+    read_reg_buf(reg, cur, addr_width);
+    if (memcmp(cur, address, addr_width) == 0) return 0;
+    write_reg(reg, address, addr_width);
+    return 1;
+}
+
+/*
+ Fast boot: after an MCU reset (brown-out, watchdog) the radio usually kept its
+ supply and its registers. Each register is read first and only rewritten when
+ it differs, and the delays are paid only when needed:
+  - RF24_POWERUP_DELAY only if the radio does not answer on SPI yet;
+  - Tpd2stby (1.5ms) only if it was powered down.
+ Returns 1 when nothing had to be written (warm radio, same settings).
+*/
+uint8_t nrf24_begin_config(uint8_t ce_pin, uint8_t csn_pin, uint32_t spi_speed_hz, const Nrf24Config *c) {
+    nrf24_hal_begin(ce_pin, csn_pin, spi_speed_hz);
+
+    uint8_t cfg = read_reg(NRF_CONFIG);
+    if (cfg == 0x00 || cfg == 0xFF) {
+        // MISO idle: still in power-on reset
+        nrf24_hal_delay_us(RF24_POWERUP_DELAY);
+        cfg = read_reg(NRF_CONFIG);
+    }
+
+    payload_size = c->payload < 1 ? 1 : (c->payload > 32 ? 32 : c->payload);
+    uint8_t channel = c->channel > 125 ? 125 : c->channel;
+    uint8_t changed = 0;
+    changed |= sync_reg(RF_CH, channel);
+    changed |= sync_reg(SETUP_RETR, c->retries);
+    // data rate and PA level: another firmware may have left them changed
+    changed |= sync_reg(RF_SETUP, c->rf_setup);
+    changed |= sync_reg(FEATURE, c->feature);
+    changed |= sync_reg(DYNPD, c->dynpd);
+    for (uint8_t i=0; i<6; i++) changed |= sync_reg(RX_PW_P0 + i, payload_size);
+    changed |= sync_reg(EN_AA, 0x01);
+    changed |= sync_reg(EN_RXADDR, 0x01);
+    // TX_ADDR and pipe0 read address must be same for ACKs
+    changed |= sync_addr(RX_ADDR_P0, c->address);
+    if (!c->rx) changed |= sync_addr(TX_ADDR, c->address);
+
+    uint8_t want = (1<<PWR_UP) | (1<<EN_CRC) | (c->rx ? (1<<PRIM_RX) : 0);
+    if (cfg != want) {
+        write_reg(NRF_CONFIG, &want, 1);
+        if (!(cfg & (1<<PWR_UP))) nrf24_hal_delay_us(1500); // Tpd2stby
+        changed = 1;
+    }
+    rf_ch = channel;
+    prim_rx = c->rx;
+
+    // drop whatever was pending before the reset, in one batch
+    uint8_t flush_rx = FLUSH_RX, flush_tx = FLUSH_TX;
+    uint8_t clear[2] = {W_REGISTER | NRF_STATUS, (1<<RX_DR) | (1<<TX_DS) | (1<<MAX_RT)};
+    Nrf24Xfer x[3] = {{&flush_rx, 1}, {&flush_tx, 1}, {clear, 2}};
+    nrf24_hal_xfer(x, 3);
+    status_reg = clear[0];
+    return !changed;
+}
+
+void nrf24_setChannel(uint8_t channel) {
+    if (channel > 125) channel = 125;
+    // skip the SPI transaction when hopping back to the same channel
+    if (channel == rf_ch) return;
+    write_reg(RF_CH, &channel, 1);
+    rf_ch = channel;
+}
+
+uint8_t nrf24_getChannel(void) {
+    if (rf_ch == 0xFF) rf_ch = read_reg(RF_CH);
+    return rf_ch;
+}
+
+void nrf24_setRetries(uint8_t delay, uint8_t count) {
+    // delay in steps of 250us (0 = 250us), count 0..15 (0 = no retransmit)
+    uint8_t v = ((delay & 0x0F) << ARD) | (count & 0x0F);
+    write_reg(SETUP_RETR, &v, 1);
+}
+
+void nrf24_setDataRate(uint8_t rate) {
+    // RF_DR_LOW wins over RF_DR_HIGH: 250k = LOW, 2M = HIGH, 1M = neither
+    uint8_t v = read_reg(RF_SETUP) & ~((1<<RF_DR_LOW) | (1<<RF_DR_HIGH));
+    if (rate == RF24_250KBPS) v |= 1<<RF_DR_LOW;
+    else if (rate == RF24_2MBPS) v |= 1<<RF_DR_HIGH;
+    write_reg(RF_SETUP, &v, 1);
+}
+
+void nrf24_setPayloadSize(uint8_t size) {
+    if (size < 1) size = 1;
+    if (size > 32) size = 32;
+    payload_size = size;
+    uint8_t p = payload_size;
+    for (uint8_t i=0; i<6; i++) write_reg(RX_PW_P0 + i, &p, 1);
+}
+
+void nrf24_openWritingPipe(const uint8_t *address) {
+    // TX_ADDR and pipe0 read address must be same for ACKs
+    write_reg(TX_ADDR, address, addr_width);
+    write_reg(RX_ADDR_P0, address, addr_width);
+}
+
+void nrf24_openReadingPipe(uint8_t pipe, const uint8_t *address) {
+    if (pipe > 5) return;
+    // pipes 2..5 only store the LSB; the other bytes are shared with pipe 1
+    write_reg(RX_ADDR_P0 + pipe, address, pipe < 2 ? addr_width : 1);
+    uint8_t en = read_reg(EN_RXADDR) | (1 << pipe);
+    write_reg(EN_RXADDR, &en, 1);
+}
+
+void nrf24_setTxAddress(const uint8_t *address) {
+    // TX_ADDR only: without ACKs, pipe 0 keeps its own reading address
+    write_reg(TX_ADDR, address, addr_width);
+}
+
+void nrf24_setAutoAck(uint8_t pipes) {
+    uint8_t v = pipes & 0x3F;
+    write_reg(EN_AA, &v, 1);
+}
+
+void nrf24_enableDynamicAck(void) {
+    sync_reg(FEATURE, read_reg(FEATURE) | (1<<EN_DYN_ACK));
+}
+
+void nrf24_startListening(void) {
+    // set PRIM_RX bit
+    uint8_t cfg = read_reg(NRF_CONFIG);
+    cfg |= (1<<PRIM_RX);
+    write_reg(NRF_CONFIG, &cfg, 1);
+    nrf24_hal_ce(1);
+    prim_rx = 1;
+    nrf24_hal_delay_us(130); // allow radio to enter RX
+}
+
+void nrf24_stopListening(void) {
+    nrf24_hal_ce(0);
+    // already in TX: CE low is standby-I, nothing to settle
+    if (!prim_rx) return;
+    // clear PRIM_RX
+    uint8_t cfg = read_reg(NRF_CONFIG);
+    cfg &= ~(1<<PRIM_RX);
+    write_reg(NRF_CONFIG, &cfg, 1);
+    prim_rx = 0;
+    nrf24_hal_delay_us(130);
+}
+
+void nrf24_powerDown(void) {
+    // registers are kept; only the crystal and the regulators stop (~0.9uA)
+    nrf24_hal_ce(0);
+    uint8_t cfg = read_reg(NRF_CONFIG);
+    cfg &= ~(1<<PWR_UP);
+    write_reg(NRF_CONFIG, &cfg, 1);
+}
+
+void nrf24_powerUp(void) {
+    uint8_t cfg = read_reg(NRF_CONFIG);
+    if (cfg & (1<<PWR_UP)) return;
+    cfg |= (1<<PWR_UP);
+    write_reg(NRF_CONFIG, &cfg, 1);
+    nrf24_hal_delay_us(1500); // Tpd2stby: crystal start-up before the next TX/RX
+}
+
+uint8_t nrf24_write(const void *buf, uint8_t len) {
+    nrf24_stopListening();
+    // write payload
+    write_payload(buf, len, W_TX_PAYLOAD);
+    // pulse CE to transmit (130us)
+    nrf24_hal_ce(1);
+    nrf24_hal_delay_us(15);
+    nrf24_hal_ce(0);
+    // Wait for TX_DS or MAX_RT
+    // naive busy wait with small timeout
+    uint16_t timeout = 5000; // ~5ms * loops => ~? conservative
+    while (timeout--) {
+        uint8_t status = read_reg(NRF_STATUS);
+        if (status & (1<<TX_DS)) {
+            // clear flag
+            uint8_t clear = (1<<TX_DS);
+            write_reg(NRF_STATUS, &clear, 1);
+            return 1; // success
+        } else if (status & (1<<MAX_RT)) {
+            uint8_t clear = (1<<MAX_RT);
+            write_reg(NRF_STATUS, &clear, 1);
+            nrf24_flush_tx();
+            return 0; // failed
+        }
+        nrf24_hal_delay_us(10);
+    }
+    // timeout
+    return 0;
+}
+
+/*
+ Non-blocking send: leaves RX without the 130us wait (the radio settles on its
+ own after CE goes high) and returns right away; nrf24_txPoll() tells when the
+ payload is gone. CE stays high until then, so the radio also sends whatever
+ is queued behind it.
+*/
+void nrf24_startWrite(const void *buf, uint8_t len, uint8_t no_ack) {
+    nrf24_hal_ce(0);
+    if (prim_rx) {
+        uint8_t cfg = read_reg(NRF_CONFIG) & ~(1<<PRIM_RX);
+        write_reg(NRF_CONFIG, &cfg, 1);
+        prim_rx = 0;
+    }
+    write_payload(buf, len, no_ack ? W_TX_PAYLOAD_NO_ACK : W_TX_PAYLOAD);
+    nrf24_hal_ce(1);
+}
+
+uint8_t nrf24_txPoll(void) {
+    uint8_t status = nrf24_getStatus();
+    if (!(status & ((1<<TX_DS) | (1<<MAX_RT)))) return 0;
+    nrf24_hal_ce(0);
+    uint8_t clear = status & ((1<<TX_DS) | (1<<MAX_RT));
+    write_reg(NRF_STATUS, &clear, 1);
+    if (status & (1<<TX_DS)) return 1;
+    nrf24_flush_tx();
+    return 2;
+}
+
+void nrf24_cancelWrite(void) {
+    // CE low stops the retries; the flush and the flag clear go in one batch
+    nrf24_hal_ce(0);
+    uint8_t flush = FLUSH_TX;
+    uint8_t clear[2] = {W_REGISTER | NRF_STATUS, (1<<TX_DS) | (1<<MAX_RT)};
+    Nrf24Xfer x[2] = {{&flush, 1}, {clear, 2}};
+    nrf24_hal_xfer(x, 2);
+    status_reg = clear[0];
+}
+
+uint8_t nrf24_retransmits(void) {
+    // ARC_CNT: retransmissions of the last payload, reset by the next one
+    return read_reg(OBSERVE_TX) & 0x0F;
+}
+
+uint8_t nrf24_availablePipe(uint8_t *pipe) {
+    // RX_P_NO follows the RX FIFO, so a second queued payload is not missed
+    // the way a cleared RX_DR can miss it
+    uint8_t p = (nrf24_getStatus() >> RX_P_NO) & 0x07;
+    if (p > 5) return 0;
+    if (pipe) *pipe = p;
+    return 1;
+}
+
+uint8_t nrf24_available(void) {
+    uint8_t status = read_reg(NRF_STATUS);
+    if (status & (1<<RX_DR)) return 1;
+    return 0;
+}
+
+void nrf24_read(void *buf, uint8_t len) {
+    // payload and the RX_DR clear in one batch
+    uint8_t rx[33] = {R_RX_PAYLOAD};
+    uint8_t n = payload_len(len);
+    memset(rx + 1, 0xff, n);
+    uint8_t clear[2] = {W_REGISTER | NRF_STATUS, (1<<RX_DR)};
+    Nrf24Xfer x[2] = {{rx, n + 1}, {clear, 2}};
+    nrf24_hal_xfer(x, 2);
+    status_reg = clear[0];
+    memcpy(buf, rx + 1, len < n ? len : n);
+}
+
+void nrf24_flush_tx(void) {
+    command(FLUSH_TX);
+}
+
+void nrf24_flush_rx(void) {
+    command(FLUSH_RX);
+}
+
+uint8_t nrf24_getStatus(void) {
+    return command(RF24_NOP);
+}
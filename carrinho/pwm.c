@@ -0,0 +1,100 @@
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#include <assert.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "pwm.h"
+
+static_assert(PWM_T0_PRESCALER_OK(PWM_LEFT_PRESCALER));
+static_assert(PWM_T2_PRESCALER_OK(PWM_RIGHT_PRESCALER));
+
+#if PWM_LEFT_MODE != PWM_RIGHT_MODE || PWM_LEFT_PRESCALER != PWM_RIGHT_PRESCALER
+#warning "PWM diferente nos dois motores: a troca de direção só fica alinhada ao Timer0"
+#endif
+
+uint8_t pwm_commit_ie = (1<<TOIE0);
+uint8_t pwm_guard_top = 250;
+
+/*
+ A seção crítica do motors_set() leva ~24 ciclos; a faixa de guarda antes do
+ ponto de troca precisa cobrir isso, em contagens do timer.
+*/
+#define GUARD_CYCLES 24
+
+static uint8_t cs_timer0(uint16_t prescaler) {
+  switch (prescaler) {
+  case 1:    return (1<<CS00);
+  case 8:    return (1<<CS01);
+  case 64:   return (1<<CS01) | (1<<CS00);
+  case 256:  return (1<<CS02);
+  case 1024: return (1<<CS02) | (1<<CS00);
+  }
+  return 0;
+}
+
+static uint8_t cs_timer2(uint16_t prescaler) {
+  switch (prescaler) {
+  case 1:    return (1<<CS20);
+  case 8:    return (1<<CS21);
+  case 32:   return (1<<CS21) | (1<<CS20);
+  case 64:   return (1<<CS22);
+  case 128:  return (1<<CS22) | (1<<CS20);
+  case 256:  return (1<<CS22) | (1<<CS21);
+  case 1024: return (1<<CS22) | (1<<CS21) | (1<<CS20);
+  }
+  return 0;
+}
+
+/**
+ * @brief Frequência resultante de uma configuração, em Hz.
+ */
+uint32_t pwm_hz(PwmConfig c) {
+  return PWM_HZ(c.mode, (uint32_t)c.prescaler);
+}
+
+/**
+ * @brief Configura o PWM dos motores (ENA no Timer0, ENB no Timer2).
+ * @return 0 se algum prescaler não existe no timer correspondente.
+ *
+ * Pode ser chamada com os motores rodando (modo bancada). Os dois timers são
+ * reiniciados juntos para que o BOTTOM/TOP coincida; o reset do prescaler
+ * também atrasa o Timer1 em até 8 ciclos.
+ */
+uint8_t pwm_setup(PwmConfig left, PwmConfig right) {
+  uint8_t cs0 = cs_timer0(left.prescaler);
+  uint8_t cs2 = cs_timer2(right.prescaler);
+  if (!cs0 || !cs2) return 0;
+
+  uint8_t sreg = SREG;
+  cli();
+
+  DDRD |= (1 << PD6);
+  TCCR0A = (1<<COM0A1) | (1<<WGM00) | (left.mode == PWM_FAST ? (1<<WGM01) : 0);
+
+  DDRD |= (1 << PD3);
+  TCCR2A = (1<<COM2B1) | (1<<WGM20) | (right.mode == PWM_FAST ? (1<<WGM21) : 0);
+
+  // Fast PWM troca a direção no BOTTOM (overflow); phase correct no TOP,
+  // pelo compare B em 0xFF (OC0B fica desconectado: PD5 é o IN3)
+  // Uma troca de direção pendente continua pendente no novo ponto de troca
+  uint8_t pending = TIMSK0 & ((1<<TOIE0) | (1<<OCIE0B));
+  OCR0B = 0xFF;
+  TIMSK0 &= ~((1<<TOIE0) | (1<<OCIE0B));
+  TIFR0 = (1<<TOV0) | (1<<OCF0B);
+  pwm_commit_ie = left.mode == PWM_FAST ? (1<<TOIE0) : (1<<OCIE0B);
+  if (pending) TIMSK0 |= pwm_commit_ie;
+  pwm_guard_top = 255 - (GUARD_CYCLES + left.prescaler - 1) / left.prescaler;
+
+  // Zera os dois PWM juntos para o BOTTOM do Timer0 e do Timer2 coincidirem
+  GTCCR = (1<<TSM) | (1<<PSRASY) | (1<<PSRSYNC);
+  TCCR0B = cs0;
+  TCCR2B = cs2;
+  TCNT0 = 0;
+  TCNT2 = 0;
+  GTCCR = 0;
+
+  SREG = sreg;
+  return 1;
+}
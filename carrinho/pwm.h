@@ -0,0 +1,43 @@
+#ifndef PWM_H
+#define PWM_H
+
+#include <stdint.h>
+
+/**
+ * @brief Modo do PWM dos motores.
+ *
+ * PWM_FAST: F_CPU / (N * 256), OCR vale a partir do BOTTOM.
+ * PWM_PHASE: F_CPU / (N * 510), simétrico, OCR vale a partir do TOP.
+ */
+typedef enum {PWM_FAST, PWM_PHASE} PwmMode;
+
+/*** CONFIGURAÇÃO ***/
+#define PWM_LEFT_MODE       PWM_FAST // ENA, Timer0 (OC0A)
+#define PWM_LEFT_PRESCALER  8        // 1, 8, 64, 256 ou 1024
+#define PWM_RIGHT_MODE      PWM_FAST // ENB, Timer2 (OC2B)
+#define PWM_RIGHT_PRESCALER 8        // 1, 8, 32, 64, 128, 256 ou 1024
+
+#define PWM_HZ(mode, prescaler) (F_CPU / (prescaler) / ((mode) == PWM_FAST ? 256UL : 510UL))
+
+#define PWM_T0_PRESCALER_OK(p) ((p) == 1 || (p) == 8 || (p) == 64 || (p) == 256 || (p) == 1024)
+#define PWM_T2_PRESCALER_OK(p) (PWM_T0_PRESCALER_OK(p) || (p) == 32 || (p) == 128)
+
+/**
+ * @brief Modo e prescaler de um canal.
+ */
+typedef struct {
+  uint8_t  mode;
+  uint16_t prescaler;
+} PwmConfig;
+
+#define PWM_LEFT_DEFAULT  ((PwmConfig){PWM_LEFT_MODE,  PWM_LEFT_PRESCALER})
+#define PWM_RIGHT_DEFAULT ((PwmConfig){PWM_RIGHT_MODE, PWM_RIGHT_PRESCALER})
+
+// Ponto de troca de direção do motors_set(), conforme o modo do Timer0
+extern uint8_t pwm_commit_ie;   // bit em TIMSK0
+extern uint8_t pwm_guard_top;   // TCNT0 a partir do qual motors_set() espera
+
+uint8_t  pwm_setup(PwmConfig left, PwmConfig right);
+uint32_t pwm_hz(PwmConfig c);
+
+#endif
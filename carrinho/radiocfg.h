@@ -0,0 +1,25 @@
+#ifndef RADIOCFG_H
+#define RADIOCFG_H
+
+#include <stdint.h>
+#include "nrf24_avr.h"
+
+/*** CONFIGURAÇÃO (precisa ser igual no carrinho e no controle) ***/
+#define RADIO_CHANNEL 76                         // Canal fixo (sem HOP_ENABLE)
+#define RADIO_ADDRESS {'0', '0', '0', '0', '1'}  // Endereço do pipe 0
+#define RADIO_RF_SETUP NRF24_RF_SETUP(RF24_2MBPS, 3) // 2Mbps, 0dBm (valor de reset)
+
+/**
+ * @brief Tempos do boot, para acompanhar a volta depois de um brown-out.
+ *
+ * Contados do início do Timer1 no main(); a partida do cristal e o
+ * bootloader não entram.
+ */
+typedef struct {
+  uint8_t  warm;      // rádio já estava configurado: nada foi regravado
+  uint8_t  channel;   // canal em que o rádio foi configurado
+  uint16_t radio_us;  // configuração do rádio (até ouvir, no carrinho)
+  uint32_t first_us;  // primeiro quadro aceito/confirmado (0 = ainda não)
+} BootStats;
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdint.h>
+#include <assert.h>
+
+/*** CONFIGURAÇÃO (precisa ser igual no carrinho e na base) ***/
+#define REPORT_MS       100   // Intervalo entre relatórios (e logo depois de cada tiro)
+#define REPORT_ADDR_LSB 0xC0  // Pipe p da base: endereço {REPORT_ADDR_LSB + p, REPORT_ADDR_TAIL}
+#define REPORT_ADDR_TAIL 'B', 'A', 'S', 'E'
+
+#define REPORT_PIPES    6     // Pipes do nRF24L01+: um carrinho (LASER_PLAYER) por pipe
+#define REPORT_SHOOTERS 4     // Jogadores que podem acertar (LASER_PLAYERS)
+#define REPORT_BOOT_SEQS 16   // Relatórios com REPORT_BOOT: o boot chega mesmo perdendo alguns
+
+#define REPORT_BOOT    (1 << 0) // Relatórios seq 0..REPORT_BOOT_SEQS-1 depois do boot: contadores recomeçam
+#define REPORT_PENALTY (1 << 1) // Em penalidade de game over
+#define REPORT_HIT     (1 << 2) // Enviado por causa de um tiro
+
+/**
+ * @brief Estado do carrinho enviado à estação base (base/), sem ACK.
+ *
+ * Os contadores são acumulados desde o boot e dão a volta em 8 ou 16 bits:
+ * um relatório perdido não perde tiros, o próximo traz a soma. A base
+ * encaminha cada um pela serial (TELEM_CAR) e o tools/based monta a partida.
+ */
+typedef struct {
+  uint16_t ms;                       // relógio do carrinho
+  uint16_t accepted;                 // enlace controle -> carrinho (FrameRx)
+  uint16_t lost;
+  uint8_t  player;                   // LASER_PLAYER (confere com o pipe)
+  uint8_t  seq;                      // número do relatório (perdas até a base)
+  uint8_t  flags;                    // REPORT_*
+  uint8_t  life;                     // LEDs de vida (carrinho.c)
+  uint8_t  latency;
+  uint8_t  channel;
+  uint8_t  hits_by[REPORT_SHOOTERS]; // tiros recebidos de cada jogador
+} CarReport;
+static_assert(sizeof(CarReport) == 16);
+
+/**
+ * @brief Registro TELEM_CAR da base: o relatório como chegou e onde.
+ */
+typedef struct {
+  uint8_t   pipe;  // pipe que recebeu
+  uint8_t   fifo;  // relatórios na FIFO de RX antes da leitura (3 = cheia, pode ter perdido)
+  CarReport report;
+} TelemCar;
+static_assert(sizeof(TelemCar) == 18);
+
+/**
+ * @brief Registro TELEM_BASE, a cada BASE_STATS_MS: recepção da própria base.
+ */
+typedef struct {
+  uint16_t reports[REPORT_PIPES]; // relatórios lidos de cada pipe desde o boot
+  uint16_t full;                  // leituras com a FIFO de RX cheia
+  uint16_t dropped;               // registros descartados com a serial cheia
+} TelemBase;
+static_assert(sizeof(TelemBase) == 16);
+
+#endif
@@ -0,0 +1,56 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "trace.h"
+#include "telem.h"
+#include "uart.h"
+
+#define TRACE_PER_RECORD (TELEM_MAX_PAYLOAD / sizeof(TraceEntry))
+
+/**
+ * @brief Congela o buffer e começa a enviá-lo (o envio anda em trace_poll()).
+ */
+void trace_dump(Trace *tr) {
+  uint8_t sreg = SREG;
+  cli();
+  if (!tr->frozen && tr->count) {
+    tr->frozen = 1;
+    tr->sent = 0;
+  }
+  SREG = sreg;
+}
+
+/**
+ * @brief Envia o próximo pedaço do buffer congelado, se couber na serial.
+ *
+ * Chamar uma vez por período, na folga do laço: cada chamada enfileira no
+ * máximo um registro TELEM_TRACE, então o envio não atrasa o laço.
+ *
+ * @return 1 enquanto houver envio em andamento.
+ */
+uint8_t trace_poll(Trace *tr, uint16_t now) {
+  if (!tr->frozen) return 0;
+
+  TraceEntry buf[TRACE_PER_RECORD];
+  uint8_t n = 0, sent = tr->sent;
+  uint8_t first = (tr->head - tr->count) & (TRACE_SIZE - 1);
+
+  if (sent == 0) buf[n++] = (TraceEntry){0, TR_DUMP, tr->count};
+  while (n < TRACE_PER_RECORD && sent < tr->count)
+    buf[n++] = tr->entry[(first + sent++) & (TRACE_SIZE - 1)];
+
+  // Sem espaço na serial: tenta o mesmo pedaço no próximo período (sem
+  // contar como descarte em telem_dropped)
+  uint8_t len = n * sizeof(TraceEntry);
+  if (uart_free() < TELEM_HEADER + len + 1) return 1;
+  telem_send(TELEM_TRACE, now, buf, len);
+  tr->sent = sent;
+
+  if (sent >= tr->count) {
+    uint8_t sreg = SREG;
+    cli();
+    tr->count = 0;
+    tr->frozen = 0;
+    SREG = sreg;
+  }
+  return tr->frozen;
+}
@@ -0,0 +1,85 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <assert.h>
+
+/*
+ Rastro de eventos do caminho quente, em RAM e sem alocação: um buffer
+ circular de TRACE_SIZE entradas (tempo em us de 16 bits, evento, argumento)
+ que sempre guarda os últimos eventos. Sob demanda, o buffer é congelado e
+ enviado pela telemetria em registros TELEM_TRACE (tools/tracedecode monta a
+ linha do tempo).
+
+ O firmware cria o Trace só quando liga TRACE_ENABLE; sem ele TRACE() some,
+ não sobra nem o buffer e o trace.o fica fora da ligação (Makefile da raiz).
+ Fora do AVR só os tipos ficam visíveis (para o decodificador no PC). O tempo
+ vem de trace_clock(), definida em cada firmware (us desde o boot, 16 bits:
+ dá a volta a cada 65ms, então o decodificador só desenrola eventos com menos
+ de 65ms entre si).
+*/
+
+/*** CONFIGURAÇÃO (precisa ser igual no carrinho e no controle) ***/
+#define TRACE_SIZE 64 // Entradas no buffer (potência de 2, até 128); 4 bytes cada
+
+static_assert((TRACE_SIZE & (TRACE_SIZE - 1)) == 0 && TRACE_SIZE <= 128);
+
+typedef enum {
+  TR_NONE,
+  TR_DUMP,        // primeira entrada do envio: arg = entradas que seguem
+  TR_LOOP,        // início do período (carrinho) ou do envio (controle)
+  TR_LOOP_END,    // fim do trabalho do período
+  TR_RX,          // quadro lido do rádio, arg = seq
+  TR_TX_START,    // amostra entregue ao txbox, arg = seq se for ao ar
+  TR_TX_DONE,     // txbox terminou o quadro, arg = 1 com ACK
+  TR_ADC,         // leitura do ADC pronta, arg = canal
+  TR_MOTOR,       // motors_set() no COMPB, arg = |duty esquerdo|
+  TR_HIT,         // tiro aceito, arg = jogador
+  TR_SLEEP,       // CPU vai dormir entre envios
+  TR_WAKE,        // CPU acordou
+  TR_EVENTS
+} TraceEvent;
+
+typedef struct {
+  uint16_t t;     // us (16 bits)
+  uint8_t  id;    // TraceEvent
+  uint8_t  arg;
+} TraceEntry;
+static_assert(sizeof(TraceEntry) == 4);
+
+typedef struct {
+  TraceEntry entry[TRACE_SIZE];
+  uint8_t    head;     // próxima entrada a escrever
+  uint8_t    count;    // entradas válidas (até TRACE_SIZE)
+  uint8_t    frozen;   // envio em andamento: novos eventos são ignorados
+  uint8_t    sent;     // entradas já enviadas no envio atual
+} Trace;
+
+#ifdef __AVR__
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+uint16_t trace_clock(void);
+
+/**
+ * @brief Grava um evento (pode ser chamada de interrupções).
+ *
+ * Custo fixo: ler o relógio, uma cópia de 4 bytes e uma máscara, com as
+ * interrupções desligadas (~40 ciclos mais o trace_clock()).
+ */
+static inline void trace_put(Trace *tr, uint8_t id, uint8_t arg) {
+  uint8_t sreg = SREG;
+  cli();
+  if (!tr->frozen) {
+    tr->entry[tr->head] = (TraceEntry){trace_clock(), id, arg};
+    tr->head = (tr->head + 1) & (TRACE_SIZE - 1);
+    if (tr->count < TRACE_SIZE) tr->count++;
+  }
+  SREG = sreg;
+}
+
+void    trace_dump(Trace *tr);
+uint8_t trace_poll(Trace *tr, uint16_t now);
+#endif
+
+#endif
@@ -0,0 +1,103 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "uart.h"
+
+/*
+ Transmissão com fila circular esvaziada pela interrupção UDRE: quem
+ escreve só copia bytes para a fila e o custo não depende da velocidade da
+ serial. A 1Mbaud sai um byte a cada 10us (~40 ciclos de ISR cada).
+
+ Um único produtor (o laço principal): uart_write() não pode ser chamada de
+ interrupções.
+
+ A recepção é só para comandos de um byte vindos do PC (uart_read()): sem
+ fila nem interrupção, o laço lê o registrador quando tem folga e o buffer
+ do próprio USART guarda até 2 bytes.
+*/
+
+#define UART_MASK (UART_TX_SIZE - 1)
+
+static uint8_t tx_buf[UART_TX_SIZE];
+static volatile uint8_t tx_head = 0;  // próxima posição livre (só o laço escreve)
+static volatile uint8_t tx_tail = 0;  // próximo byte a sair (só a ISR escreve)
+static uint8_t tx_used = 0;           // já enfileirou algo (o TXC0 vai subir)
+
+ISR(USART_UDRE_vect) {
+  uint8_t t = tx_tail;
+  UDR0 = tx_buf[t];
+  t = (t + 1) & UART_MASK;
+  tx_tail = t;
+  if (t == tx_head) UCSR0B &= ~(1 << UDRIE0);
+}
+
+/**
+ * @brief 8N1 em UART_BAUD; o RX (PD0) fica com pull-up para não ler ruído solto.
+ */
+void uart_begin(void) {
+  PORTD |= (1 << PD0);
+  UBRR0 = UART_UBRR;
+  UCSR0A = (1 << U2X0);
+  UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+  UCSR0B = (1 << TXEN0) | (1 << RXEN0);
+  tx_head = tx_tail = 0;
+}
+
+uint8_t uart_free(void) {
+  return (tx_tail - tx_head - 1) & UART_MASK;
+}
+
+/**
+ * @brief Enfileira len bytes inteiros ou nenhum.
+ * @return 1 se coube; 0 se a fila não tinha espaço (nada é escrito).
+ *
+ * Custo fixo por byte (cópia e máscara), sem esperar a serial.
+ */
+uint8_t uart_write(const void *buf, uint8_t len) {
+  if (len > uart_free()) return 0;
+
+  const uint8_t *p = buf;
+  uint8_t h = tx_head;
+  for (uint8_t i = 0; i < len; i++) {
+    tx_buf[h] = p[i];
+    h = (h + 1) & UART_MASK;
+  }
+  tx_head = h;
+  tx_used = 1;
+
+  uint8_t sreg = SREG;
+  cli();
+  UCSR0A = (1 << U2X0) | (1 << TXC0);  // TXC0 volta a marcar o fim para o uart_flush()
+  UCSR0B |= (1 << UDRIE0);
+  SREG = sreg;
+  return 1;
+}
+
+/**
+ * @brief Espera a fila e o último byte saírem (fora do laço de tempo real).
+ */
+void uart_flush(void) {
+  if (!tx_used) return;
+  while (tx_head != tx_tail);
+  while (!(UCSR0A & (1 << TXC0)));
+}
+
+/**
+ * @brief Ainda há bytes na fila ou saindo pelo pino (sem esperar).
+ *
+ * Para quem vai dormir num modo que para o clkIO e não quer esperar o
+ * uart_flush().
+ */
+uint8_t uart_busy(void) {
+  return tx_used && !(UCSR0A & (1 << TXC0));
+}
+
+/**
+ * @brief Lê um byte recebido, sem esperar.
+ * @return o byte, ou -1 se não chegou nada (ou chegou com erro de quadro).
+ */
+int16_t uart_read(void) {
+  uint8_t status = UCSR0A;
+  if (!(status & (1 << RXC0))) return -1;
+  uint8_t c = UDR0;
+  return status & ((1 << FE0) | (1 << DOR0) | (1 << UPE0)) ? -1 : c;
+}
@@ -0,0 +1,122 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/wdt.h>
+#include "wdog.h"
+
+#define WDOG_MAGIC 0xA5
+
+/*
+ Supervisão do laço pelo watchdog, em modo interrupção + reset.
+
+ Cada laço marca as tarefas que rodou com wdog_done(); o chute só conta
+ quando todas rodaram. A interrupção vem a cada período do watchdog e rearma
+ o modo interrupção se houve chute desde a anterior. Sem chute, wdog_isr() é
+ a última chance: o firmware põe as saídas em estado seguro e o reset vem um
+ período depois. Um travamento é percebido em até dois períodos; com
+ interrupções desligadas o reset vem direto.
+
+ O contador do watchdog nunca é zerado pelo laço (sem wdr), então o período
+ continua regular e serve também de base de tempo (POWER_WDT no controle).
+
+ O bootloader do Arduino (optiboot) zera o MCUSR antes de pular para o
+ firmware; por isso a causa também é anotada em .noinit pela interrupção.
+*/
+
+ResetStats reset_stats __attribute__((section(".noinit")));
+static uint8_t mcusr __attribute__((section(".noinit")));
+
+static volatile uint8_t tasks = 0;
+
+static uint8_t all_tasks = 0;
+static volatile uint8_t kicked = 0;
+
+/**
+ * @brief Logo depois do reset, antes de zerar a RAM: guarda o MCUSR e
+ * desliga o watchdog (que continua ligado, em 15ms, depois de um reset dele).
+ */
+static void __attribute__((naked, used, section(".init3"))) wdog_early(void) {
+  mcusr = MCUSR;
+  MCUSR = 0;
+  wdt_disable();
+}
+
+/**
+ * @brief Contabiliza o reset que acabou de acontecer (chamar no início do main()).
+ */
+void wdog_boot(void) {
+  uint8_t cause;
+  if (mcusr & (1 << WDRF))        cause = RESET_WATCHDOG;
+  else if (mcusr & (1 << BORF))   cause = RESET_BROWN_OUT;
+  else if (mcusr & (1 << EXTRF))  cause = RESET_EXTERNAL;
+  else if (mcusr & (1 << PORF))   cause = RESET_POWER_ON;
+  else if (reset_stats.magic == WDOG_MAGIC && reset_stats.pending) cause = RESET_WATCHDOG;
+  else                            cause = RESET_UNKNOWN;
+
+  if (reset_stats.magic != WDOG_MAGIC || cause == RESET_POWER_ON) {
+    reset_stats = (ResetStats){0};
+    reset_stats.magic = WDOG_MAGIC;
+  }
+  if (cause == RESET_WATCHDOG && !reset_stats.pending) reset_stats.stalled = 0; // travou com cli
+  reset_stats.cause = cause;
+  reset_stats.pending = 0;
+  reset_stats.count[cause]++;
+}
+
+/**
+ * @brief Liga o watchdog em modo interrupção + reset.
+ * @param timeout WDTO_15MS ... WDTO_8S.
+ * @param all máscara com todas as tarefas que precisam rodar entre dois chutes.
+ */
+void wdog_start(uint8_t timeout, uint8_t all) {
+  uint8_t wdp = (timeout & 0x07) | ((timeout & 0x08) ? (1 << WDP3) : 0);
+  uint8_t sreg = SREG;
+  cli();
+  all_tasks = all;
+  tasks = 0;
+  kicked = 1;
+  wdt_reset();
+  WDTCSR = (1 << WDCE) | (1 << WDE);
+  WDTCSR = (1 << WDE) | (1 << WDIE) | wdp;
+  SREG = sreg;
+}
+
+void wdog_stop(void) {
+  uint8_t sreg = SREG;
+  cli();
+  all_tasks = 0;
+  wdt_disable();
+  SREG = sreg;
+}
+
+/**
+ * @brief Marca uma tarefa do laço; conta um chute quando todas rodaram.
+ */
+void wdog_done(uint8_t task) {
+  uint8_t sreg = SREG;
+  cli();
+  tasks |= task;
+  if (all_tasks && tasks == all_tasks) {
+    tasks = 0;
+    kicked = 1;
+  }
+  SREG = sreg;
+}
+
+/**
+ * @brief Chamar na ISR(WDT_vect).
+ *
+ * @return 1 se o laço chutou desde a última interrupção (o modo interrupção é
+ * rearmado); 0 se travou: o reset vem no próximo período e o firmware deve pôr
+ * as saídas em estado seguro.
+ */
+uint8_t wdog_isr(void) {
+  if (!all_tasks) return 1;
+  if (kicked) {
+    kicked = 0;
+    WDTCSR |= (1 << WDIE);
+    return 1;
+  }
+  reset_stats.stalled = all_tasks & ~tasks;
+  reset_stats.pending = 1;
+  return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef WDOG_H
+#define WDOG_H
+
+#include <stdint.h>
+
+/**
+ * @brief Causa do último reset, em ResetStats.count.
+ *
+ * RESET_UNKNOWN aparece quando o bootloader já limpou o MCUSR e o watchdog
+ * não chegou a avisar (reset com interrupções desligadas).
+ */
+typedef enum {
+  RESET_POWER_ON,
+  RESET_EXTERNAL,
+  RESET_BROWN_OUT,
+  RESET_WATCHDOG,
+  RESET_UNKNOWN,
+  RESET_CAUSES
+} ResetCause;
+
+/**
+ * @brief Contadores de reset, preservados entre resets (.noinit).
+ *
+ * Zerados só no power-on (ou se o magic não bater). restart_us é preenchido
+ * pelo firmware a cada boot.
+ */
+typedef struct {
+  uint8_t  magic;
+  uint8_t  cause;               // ResetCause do último reset
+  uint8_t  stalled;             // tarefas que faltavam no último estouro do watchdog
+  uint8_t  pending;             // o watchdog avisou e o reset vem em seguida
+  uint16_t count[RESET_CAUSES];
+  uint32_t restart_us;          // do main() ao primeiro período do laço, sem bancada/calibração
+} ResetStats;
+
+extern ResetStats reset_stats;
+
+void    wdog_boot(void);
+void    wdog_start(uint8_t timeout, uint8_t all);
+void    wdog_stop(void);
+void    wdog_done(uint8_t task);
+uint8_t wdog_isr(void);
+
+#endif
@@ -4,12 +4,96 @@
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
 #include "nrf24_avr.h"
+#include "radiocfg.h"
+#include "hop.h"
+#include "frame.h"
+#include "stick.h"
+#include "txbox.h"
+#include "wdog.h"
+#include "uart.h"
+#include "telem.h"
+#include "trace.h"
+#include "hist.h"
 
 #define HIGH 1
 #define LOW  0
 
+#define POWER_BUSY 0 // espera a grade girando no laço
+#define POWER_IDLE 1 // dorme em Idle entre os ticks de 1ms do Timer1
+#define POWER_WDT  2 // dorme em Power-down entre envios e acorda pelo watchdog
+
+/*** CONFIGURAÇÃO ***/
+#define ADC_QUIET // Converte o ADC dormindo (ADC Noise Reduction), com CPU e SPI parados
+#define POWER_MODE POWER_IDLE // Espera entre envios (ver "Consumo do controle" no README)
+#define DORMANT_S  60         // Parado por esse tempo: desliga rádio e CPU até um botão (0 = nunca)
+#define TELEM_ENABLE          // Telemetria na serial (PD1/TXD, UART_BAUD em uart.h)
+//#define TRACE_ENABLE          // Rastro de eventos; JS e TRIGGER juntos enviam pela telemetria
+#define HIST_ENABLE           // Histogramas de tempo do envio; JS e TRIGGER juntos enviam
+
+#if POWER_MODE == POWER_WDT && defined(HOP_ENABLE)
+#error "POWER_WDT não segue a grade do salto de canal (o watchdog varia ~10%)"
+#endif
+static_assert(DORMANT_S <= 60); // cabe nos 16 bits de ms
+static_assert(TXBOX_DEADLINE_MS < HOP_PERIOD_MS); // o quadro no ar vence antes do próximo envio
+
+// Laço travado: reset em até 3 períodos do watchdog
+#if POWER_MODE == POWER_WDT
+#define WDOG_TIMEOUT WDTO_15MS // o mesmo período que acorda a CPU
+#else
+#define WDOG_TIMEOUT WDTO_60MS
+#endif
+
+#ifdef TELEM_ENABLE
+#define TELEM(type, payload) telem_send((type), ticks_ms(), &(payload), sizeof(payload))
+#else
+#define TELEM(type, payload) ((void)(payload))
+#endif
+
+#ifdef TRACE_ENABLE
+#ifndef TELEM_ENABLE
+#error "TRACE_ENABLE precisa de TELEM_ENABLE para enviar o rastro"
+#endif
+#define TRACE(id, arg) trace_put(&trace, (id), (arg))
+Trace trace;
+#elif defined(BENCH_MARKS)
+// make bench: cada ponto do rastro vira uma escrita em GPIOR0, que o
+// tools/avrbench marca com o ciclo exato do simulador
+#define TRACE(id, arg) (GPIOR0 = (id))
+#else
+#define TRACE(id, arg) ((void)0)
+#endif
+
+#ifdef HIST_ENABLE
+#ifndef TELEM_ENABLE
+#error "HIST_ENABLE precisa de TELEM_ENABLE para enviar os histogramas"
+#endif
+#define HIST_START(t)       uint16_t t = hist_clock()
+#define HIST_LAP(id, since) hist_lap(&hist[id], &(since))
+#define HIST_ADD(id, v)     hist_add(&hist[id], (v))
+Hist hist[HIST_IDS];
+uint16_t period_start;
+uint16_t tx_start;  // amostra entregue ao txbox (HIST_RADIO)
+#else
+#define HIST_START(t)
+#define HIST_LAP(id, since) ((void)0)
+#define HIST_ADD(id, v)     ((void)0)
+#endif
+
+// Tarefas que precisam rodar entre duas interrupções do watchdog
+#define TASK_READ (1<<0)
+#define TASK_SEND (1<<1)
+#define TASK_ALL  (TASK_READ | TASK_SEND)
+
+#ifdef ADC_QUIET
+#define DEADZONE 20 // Só a folga mecânica do manche, em volta do centro calibrado
+#else
 #define DEADZONE 60
+#endif
+#define CAL_SAMPLES 64 // Leituras somadas para achar o centro na calibração
 
 // Mapeamento físico equivalente ao Arduino
 #define LED1 3
@@ -21,115 +105,547 @@
 #define JS 2
 #define TRIGGER 3
 
+#if FRAME_REDUNDANCY > 0
+// Sem retransmissão: a perda é absorvida pelo histórico do próximo quadro
+#define RADIO_RETRIES 0x00
+#else
+#define RADIO_RETRIES 0x03 // valor de reset: 250us, 3 tentativas
+#endif
+const Nrf24Config radio_config = {
+    RADIO_CHANNEL, sizeof(Frame), RADIO_RETRIES, RADIO_RF_SETUP, 0, 0, 0, RADIO_ADDRESS,
+};
+
+/**
+ * @brief Configura PWM dos pinos LED1 e LED2.
+ */
+void pwm_setup() {
+    // LED1 -> PD3 (OC2B)
+    DDRD |= (1 << 3);
+    TCCR2A = (1<<WGM21) | (1<<WGM20) | (1<<COM2B1);
+    TCCR2B = (1<<CS21);   // prescaler 8
+
+    // LED2 -> PD5 (OC0B)
+    DDRD |= (1 << PD5);
+    TCCR0A = (1<<WGM01) | (1<<WGM00) | (1<<COM0B1);
+    TCCR0B = (1<<CS01);   // prescaler 8
+}
+
 /**
- * @brief Função equivalente ao map() do Arduino.
+ * @brief Escreve valor PWM em LED1 ou LED2.
  *
- * @param x valor de entrada
- * @param in_min faixa mínima de entrada
- * @param in_max faixa máxima de entrada
- * @param out_min faixa mínima de saída
- * @param out_max faixa máxima de saída
- * @return valor mapeado proporcionalmente
+ * @param pin 3 ou 5
+ * @param value intensidade 0–255
  */
-long map(long x, long in_min, long in_max, long out_min, long out_max) {
-    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+void pwm_write(uint8_t pin, uint8_t value) {
+    if (pin == 3)      OCR2B = value;
+    else if (pin == 5) OCR0B = value;
 }
 
 /**
- * @brief Estrutura enviada/recebida pelo controle RF.
+ * @brief Retorna valor absoluto de um inteiro.
+ */
+int abs_int(int n) { return n >= 0 ? n : -n; }
+
+#define T1_COUNTS_PER_MS 2000 // 16MHz / 8
+#define WDT_MS           16   // período nominal do watchdog (WDP = 0)
+
+/**
+ * @brief Configura o Timer1 como base de tempo de 1ms.
  *
- * x e y variam de -127 a 127.
- * sw e trigger são botões (0 ou 1).
+ * O Timer0 fica só com o PWM do LED2 (o pwm_setup() troca o prescaler dele).
+ *
+ * Com POWER_WDT a base de tempo passa a ser o watchdog, que continua contando
+ * no Power-down, e o Timer1 corre livre sem interrupção: como ele para junto
+ * com o clkIO, a contagem dele é o tempo acordado.
  */
-typedef struct {
-    int8_t x;
-    int8_t y;
-    int8_t sw;
-    int8_t trigger;
-} Controls;
-static_assert(sizeof(Controls) == 4);
+void timer1_setup() {
+    sei();
+    TCCR1A = 0;
+#if POWER_MODE == POWER_WDT
+    TCCR1B = (1 << CS11);  // normal, prescaler de 8
+    TIMSK1 = 0;
+    // Só interrupção, a cada WDT_MS, até o wdog_start() ligar a supervisão
+    cli();
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = (1 << WDIE);
+    sei();
+#else
+    TCCR1B = (1 << WGM12) | (1 << CS11); // CTC, prescaler de 8
+    OCR1A = T1_COUNTS_PER_MS - 1;        // 16MHz / 8 / 2000 = 1kHz
+    TIMSK1 = (1 << OCIE1A);
+#endif
+}
 
-const uint8_t address[5] = {'0','0','0','0','1'};
+volatile uint16_t ms_ticks = 0;
+#if POWER_MODE != POWER_WDT
+ISR(TIMER1_COMPA_vect) {
+    HIST_ADD(HIST_TICK_LAT, TCNT1);  // o CTC zerou o TCNT1 no compare
+    ms_ticks++;
+}
+#endif
 
 /**
- * @brief Inicializa o ADC do AVR para leitura dos analógicos.
+ * @brief Watchdog: supervisão do laço (e, com POWER_WDT, a base de tempo).
+ *
+ * No controle não há saída perigosa: sem chute, só espera o reset.
  */
-void adc_setup() {
-    ADMUX = (1 << REFS0); 
-    ADCSRA = (1 << ADEN) | (1<<ADPS2) | (1<<ADPS1) | (1<<ADPS0); 
+ISR(WDT_vect) {
+#if POWER_MODE == POWER_WDT
+    ms_ticks += WDT_MS;
+#endif
+    wdog_isr();
+}
+
+/**
+ * @brief Lê o contador de milissegundos sem ser interrompido no meio.
+ */
+uint16_t ticks_ms(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t t = ms_ticks;
+    SREG = sreg;
+    return t;
 }
 
+#ifdef ADC_QUIET
+/*
+ No ADC Noise Reduction o clkIO para, e com ele o Timer1: cada conversão
+ atrasa o relógio de ms em 13 ciclos de ADC mais, em média, meio ciclo de ADC
+ até a conversão começar. O atraso é devolvido ao Timer1 depois de acordar;
+ o erro que sobra é de até ±8 contagens (4us) por leitura.
+*/
+#define ADC_QUIET_T1_COUNTS ((13 * 128 + 64) / 8)
+
+EMPTY_INTERRUPT(ADC_vect);
+
+/**
+ * @brief O ADC Noise Reduction para a UART junto com o clkIO.
+ */
+static uint8_t adc_can_sleep(void) {
+#ifdef TELEM_ENABLE
+    return !uart_busy();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief Adianta o Timer1 pelo tempo em que ficou parado (chamar com cli).
+ */
+static void timer1_skip(uint16_t counts) {
+#if POWER_MODE == POWER_WDT
+    TCNT1 += counts; // só soma ao tempo acordado
+#else
+    uint16_t t = TCNT1 + counts;
+    if (t > OCR1A) {
+        t -= OCR1A + 1;
+        ms_ticks++;
+    }
+    TCNT1 = t;
+#endif
+}
+#endif
+
 /**
  * @brief Lê o ADC em um canal específico.
  *
+ * Com ADC_QUIET a conversão é feita dormindo: a CPU, o SPI e os timers
+ * síncronos param e só a interrupção do ADC acorda. O rádio não perde nada
+ * porque o controle só transmite, e as leituras ficam logo depois do ponto da
+ * grade de envio, depois que o quadro anterior já saiu (ou venceu) no txbox.
+ * A UART também para nesse modo: com telemetria ainda saindo, a conversão é
+ * feita acordada para não cortar o byte no meio.
+ *
  * @param ch canal analógico (0–7)
  * @return valor de 0 a 1023
  */
 uint16_t adc_read(uint8_t ch) {
     ADMUX = (ADMUX & 0xF0) | (ch & 0x07);
+#ifdef ADC_QUIET
+    if (!adc_can_sleep()) {
+        ADCSRA |= (1 << ADSC);
+        while (ADCSRA & (1 << ADSC));
+        return ADC;
+    }
+    ADCSRA |= (1 << ADIE);
+    set_sleep_mode(SLEEP_MODE_ADC);
+    uint8_t sreg = SREG;
+    cli();
+    sleep_enable();
+    sei();
+    sleep_cpu();  // a conversão começa ao entrar no modo
+    sleep_disable();
+    cli();
+    timer1_skip(ADC_QUIET_T1_COUNTS);
+    SREG = sreg;
+    ADCSRA &= ~(1 << ADIE);
+#else
     ADCSRA |= (1 << ADSC);
+#endif
     while (ADCSRA & (1 << ADSC));
     return ADC;
 }
 
 /**
- * @brief Configura PWM dos pinos LED1 e LED2.
+ * @brief Inicializa o ADC do AVR para leitura dos analógicos.
+ *
+ * Faz a primeira conversão (25 ciclos de ADC em vez de 13) já aqui, para que
+ * todas as leituras do laço durem o mesmo.
  */
-void pwm_setup() {
-    // LED1 -> PD3 (OC2B)
-    DDRD |= (1 << 3);
-    TCCR2A = (1<<WGM21) | (1<<WGM20) | (1<<COM2B1);
-    TCCR2B = (1<<CS21);   // prescaler 8
+void adc_setup() {
+    ADMUX = (1 << REFS0); 
+    ADCSRA = (1 << ADEN) | (1<<ADPS2) | (1<<ADPS1) | (1<<ADPS0); 
+    DIDR0 = (1 << ADC0D) | (1 << ADC1D);
+    adc_read(JY);
+}
 
-    // LED2 -> PD5 (OC0B)
-    DDRD |= (1 << PD5);
-    TCCR0A = (1<<WGM01) | (1<<WGM00) | (1<<COM0B1);
-    TCCR0B = (1<<CS01);   // prescaler 8
+/**
+ * @brief Fração do tempo em que a CPU fica acordada.
+ *
+ * Medida em contagens do Timer1 (0,5us) e fechada a cada segundo; duty e
+ * awake_us entram no tools/powerbudget para estimar a bateria.
+ */
+typedef struct {
+    uint32_t slept;     // contagens dormindo na janela atual (POWER_IDLE)
+    uint32_t awake;     // contagens acordado na janela atual (POWER_WDT)
+    uint16_t window;    // início da janela atual (ms)
+    uint16_t sends;     // amostras entregues ao txbox na janela atual
+    uint16_t failed;    // envios sem ACK na janela atual (MAX_RT ou vencidos)
+    uint16_t duty;      // fração acordada da última janela (1/1000)
+    uint16_t awake_us;  // tempo acordado por envio na última janela (us)
+} PowerStats;
+
+PowerStats power;
+
+/**
+ * @brief Captura o tempo em us desde o timer1_setup() (até ~65s).
+ *
+ * Com POWER_WDT a resolução é a do watchdog (WDT_MS).
+ */
+uint32_t timer1_us(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t ms = ms_ticks;
+#if POWER_MODE == POWER_WDT
+    SREG = sreg;
+    return (uint32_t)ms * 1000;
+#else
+    uint16_t t = TCNT1;
+    if ((TIFR1 & (1 << OCF1A)) && t < T1_COUNTS_PER_MS / 2) ms++; // tick pendente
+    SREG = sreg;
+    return (uint32_t)ms * 1000 + t / (T1_COUNTS_PER_MS / 1000);
+#endif
 }
 
 /**
- * @brief Escreve valor PWM em LED1 ou LED2.
+ * @brief timer1_us() em 16 bits, para o rastro (chamada com cli).
  *
- * @param pin 3 ou 5
- * @param value intensidade 0–255
+ * Com POWER_WDT soma ao último tick do watchdog o tempo acordado desde ele,
+ * então a resolução dentro de um envio continua de 0,5us.
  */
-void pwm_write(uint8_t pin, uint8_t value) {
-    if (pin == 3)      OCR2B = value;
-    else if (pin == 5) OCR0B = value;
+uint16_t trace_clock(void) {
+    uint16_t t = TCNT1;
+    uint16_t ms = ms_ticks;
+#if POWER_MODE != POWER_WDT
+    if ((TIFR1 & (1 << OCF1A)) && t < T1_COUNTS_PER_MS / 2) ms++;
+#endif
+    return ms * 1000u + t / (T1_COUNTS_PER_MS / 1000);
 }
 
 /**
- * @brief Retorna valor absoluto de um inteiro.
+ * @brief Timer1 em contagens (0,5us) desde o boot, em 16 bits, para hist.h.
+ *
+ * Com POWER_WDT é o último tick do watchdog mais o tempo acordado desde ele.
  */
-int abs_int(int n) { return n >= 0 ? n : -n; }
+uint16_t hist_clock(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t t = TCNT1;
+    uint16_t ms = ms_ticks;
+#if POWER_MODE != POWER_WDT
+    if ((TIFR1 & (1 << OCF1A)) && t < T1_COUNTS_PER_MS / 2) ms++;
+#endif
+    SREG = sreg;
+    return ms * T1_COUNTS_PER_MS + t;
+}
 
-void timer0_setup() {
-    sei();
-    TCCR0A = 0;
-    TCCR0B = (1 << CS02) | (1 << CS00); // Prescaler de 1024
-    TIMSK0 = (1 << TOIE0);
-    TCNT0 = 0;
+BootStats boot;
+
+#if POWER_MODE == POWER_IDLE
+/**
+ * @brief Tempo do Timer1 em contagens desde o boot (chamar com cli).
+ */
+static uint32_t timer1_counts(void) {
+    uint16_t t = TCNT1;
+    uint16_t ms = ms_ticks;
+    if ((TIFR1 & (1 << OCF1A)) && t < T1_COUNTS_PER_MS / 2) ms++; // tick pendente
+    return (uint32_t)ms * T1_COUNTS_PER_MS + t;
+}
+#endif
+
+TxBox txbox;
+
+/**
+ * @brief Conta um envio e fecha a janela de 1s do duty (e manda TELEM_POWER).
+ */
+static void power_account(uint16_t now) {
+    power.sends++;
+    uint16_t elapsed = now - power.window;
+    if (elapsed < 1000) return;
+
+#if POWER_MODE == POWER_WDT
+    uint32_t awake = power.awake;
+#else
+    uint32_t awake = (uint32_t)elapsed * T1_COUNTS_PER_MS - power.slept;
+#endif
+    power.duty = awake * 1000 / ((uint32_t)elapsed * T1_COUNTS_PER_MS);
+    power.awake_us = awake / (T1_COUNTS_PER_MS / 1000) / power.sends;
+
+    TelemPower r = {power.duty, power.awake_us, power.sends, power.failed, txbox.superseded, txbox.expired};
+    TELEM(TELEM_POWER, r);
+    txbox.superseded = txbox.expired = 0;
+
+    power.slept = power.awake = 0;
+    power.sends = power.failed = 0;
+    power.window = now;
+}
+
+StickCal stick_ee EEMEM;
+int8_t stick_lut[2][STICK_LUT_SIZE]; // eixo (0 = X, 1 = Y), ADC >> STICK_LUT_SHIFT -> -127..127
+
+/**
+ * @brief Espera ms milissegundos girando (só fora do laço de envio).
+ */
+static void wait_ms(uint16_t ms) {
+    uint16_t t0 = ticks_ms();
+    while ((uint16_t)(ticks_ms() - t0) < ms);
+}
+
+/**
+ * @brief Espera o JS ficar solto por 50ms seguidos (debounce).
+ */
+static void wait_js_released(void) {
+    uint16_t t0 = ticks_ms();
+    while ((uint16_t)(ticks_ms() - t0) < 50) {
+        if (!(PINC & (1<<JS))) t0 = ticks_ms();
+    }
+}
+
+/**
+ * @brief Pisca um LED n vezes.
+ */
+static void blink(uint8_t pin, uint8_t n) {
+    while (n--) {
+        pwm_write(pin, 255);
+        wait_ms(150);
+        pwm_write(pin, 0);
+        wait_ms(150);
+    }
 }
 
-volatile uint8_t ovf_count = 0;
-ISR(TIMER0_OVF_vect) {
-    ovf_count++;
+/**
+ * @brief Modo de calibração, com o JS apertado ao ligar.
+ *
+ *  1. Solte o JS com o manche parado: o centro é a média de CAL_SAMPLES
+ *     leituras de cada eixo e o LED2 acende.
+ *  2. Leve o manche até os batentes em todas as direções: guarda o mínimo e o
+ *     máximo; o LED1 mostra o quanto o eixo Y já andou.
+ *  3. Aperte o JS de novo: grava na EEPROM se os cursos passarem em
+ *     stick_valid() (LED2 pisca 3 vezes); senão mantém a calibração anterior
+ *     (LED1 pisca 3 vezes).
+ */
+static void stick_calibrate(void) {
+    StickCal cal;
+    const uint8_t ch[2] = {JX, JY};
+
+    wait_js_released();
+    wait_ms(300);  // o manche volta ao centro depois de soltar
+    for (uint8_t i = 0; i < 2; i++) {
+        uint32_t sum = 0;
+        for (uint8_t k = 0; k < CAL_SAMPLES; k++) sum += adc_read(ch[i]);
+        uint16_t center = (sum + CAL_SAMPLES / 2) / CAL_SAMPLES;
+        cal.axis[i] = (AxisCal){center, center, center};
+    }
+    pwm_write(LED2, 255);
+
+    while (PINC & (1<<JS)) {
+        for (uint8_t i = 0; i < 2; i++) {
+            uint16_t v = adc_read(ch[i]);
+            if (v < cal.axis[i].min) cal.axis[i].min = v;
+            if (v > cal.axis[i].max) cal.axis[i].max = v;
+        }
+        pwm_write(LED1, (cal.axis[1].max - cal.axis[1].min) >> 2);
+    }
+    pwm_write(LED1, 0);
+    pwm_write(LED2, 0);
+    wait_js_released();
+
+    stick_seal(&cal);
+    if (stick_valid(&cal)) {
+        eeprom_update_block(&cal, &stick_ee, sizeof(cal));
+        blink(LED2, 3);
+    } else {
+        blink(LED1, 3);
+    }
+}
+
+/**
+ * @brief Lê a calibração da EEPROM e monta as tabelas dos dois eixos.
+ *
+ * Sem calibração válida usa o eixo ideal 0..1023. Depois disso cada leitura do
+ * manche custa só um acesso à tabela (zona morta incluída).
+ */
+static void stick_load(void) {
+    StickCal cal;
+    eeprom_read_block(&cal, &stick_ee, sizeof(cal));
+    if (!stick_valid(&cal)) stick_defaults(&cal);
+    for (uint8_t i = 0; i < 2; i++) stick_build(stick_lut[i], &cal.axis[i], DEADZONE);
+}
+
+/**
+ * @brief Anda o envio do txbox e trata o fim de cada quadro.
+ *
+ * O resultado (LED2, primeiro quadro confirmado, envios sem ACK) chega aqui,
+ * no laço ou na espera da grade, sem segurar o laço até o ACK.
+ */
+static void radio_poll(void) {
+    uint8_t r = txbox_poll(&txbox, ticks_ms());
+    if (r < TXBOX_SENT) return;
+
+    uint8_t ok = r == TXBOX_SENT;
+    HIST_LAP(HIST_RADIO, tx_start);
+    TRACE(TR_TX_DONE, ok);
+    if (!ok) power.failed++;
+    if (ok && !boot.first_us) {
+        boot.first_us = timer1_us();
+        TelemBoot b = {boot.warm, boot.channel, boot.radio_us, boot.first_us};
+        TELEM(TELEM_BOOT, b);
+    }
+    pwm_write(LED2, ok);
 }
 
+static uint16_t next_send = 0;
+
+/**
+ * @brief Espera o próximo ponto da grade de 20ms.
+ *
+ * Se o laço atrasou, descarta os pontos perdidos em vez de enviar atrasado,
+ * mantendo a grade alinhada ao salto de canal. O quadro no ar anda enquanto
+ * espera (radio_poll()).
+ *
+ * Com POWER_IDLE a espera é em Idle: o Timer1 e o PWM dos LEDs continuam e o
+ * tick de 1ms acorda a CPU para conferir a grade. Com POWER_WDT a CPU vai para
+ * Power-down (o ADC é desligado junto) e a grade passa a ser a do watchdog,
+ * WDT_MS ±10% em vez de HOP_PERIOD_MS; os LEDs apagam enquanto ela dorme.
+ */
 void delay20ms() {
-    ovf_count = 0;
-    TCNT0 = 0;
+    TRACE(TR_SLEEP, 0);
+#if POWER_MODE == POWER_WDT
+    // O quadro no ar termina antes (o prazo do txbox limita a espera)
+    while (txbox.busy) radio_poll();
+#ifdef TELEM_ENABLE
+    uart_flush();  // o Power-down para a UART no meio do byte
+#endif
+    ADCSRA &= ~(1 << ADEN);
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    cli();
+    power.awake += TCNT1;
+    TCNT1 = 0;
+    sleep_enable();
+    sleep_bod_disable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    ADCSRA |= (1 << ADEN);
+#else
+    next_send += HOP_PERIOD_MS;
+    while ((int16_t)(ticks_ms() - next_send) >= HOP_PERIOD_MS) next_send += HOP_PERIOD_MS;
+#if POWER_MODE == POWER_IDLE
+    // Confere a grade com cli para o tick não escapar entre o teste e o sleep
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    while ((int16_t)(ms_ticks - next_send) < 0) {
+        uint32_t t0 = timer1_counts();
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+        power.slept += timer1_counts() - t0;
+        if (txbox.busy) {
+            // o tick acorda a cada 1ms: confere o quadro no ar
+            sei();
+            radio_poll();
+            cli();
+        }
+    }
+    sei();
+#else
+    while ((int16_t)(ticks_ms() - next_send) < 0) radio_poll();
+#endif
+#endif
+    TRACE(TR_WAKE, 0);
+}
 
-    // Espera 1 ovf + 56 counts = 20ms
-    while (ovf_count < 1);
-    while (TCNT0 < 56);
+#if DORMANT_S > 0
+#define BUTTONS ((1 << JS) | (1 << TRIGGER))
+
+EMPTY_INTERRUPT(PCINT1_vect);
+
+/**
+ * @brief Desliga rádio, LEDs e ADC e dorme em Power-down até um botão.
+ *
+ * Só os botões acordam (interrupção de mudança de pino em JS e TRIGGER); o
+ * manche sozinho não, porque ler os potenciômetros exige o ADC ligado. No
+ * Power-down o Timer1 para, então ms_ticks não anda enquanto dorme.
+ */
+static void power_dormant(void) {
+    while (txbox.busy || txbox.full) radio_poll();
+#ifdef TELEM_ENABLE
+    uart_flush();
+#endif
+    nrf24_powerDown();
+    TCCR2A &= ~(1 << COM2B1);  // LEDs viram GPIO em nível baixo
+    TCCR0A &= ~(1 << COM0B1);
+    ADCSRA &= ~(1 << ADEN);
+
+    PCMSK1 = (1 << PCINT10) | (1 << PCINT11);  // PC2 (JS) e PC3 (TRIGGER)
+    PCIFR = (1 << PCIF1);
+    PCICR |= (1 << PCIE1);
+    wdog_stop();  // sem laço para supervisionar (e sem acordar a cada período)
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    // Um ruído no pino também acorda; volta a dormir até um botão
+    cli();
+    while ((PINC & BUTTONS) == BUTTONS) {
+        sleep_enable();
+        sleep_bod_disable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+    }
+    sei();
+    PCICR &= ~(1 << PCIE1);
+
+    ADCSRA |= (1 << ADEN);
+    pwm_setup();
+    nrf24_powerUp();
+    wdog_start(WDOG_TIMEOUT, TASK_ALL);
 }
+
+static uint16_t still_since = 0;
+#endif
+
+
+#ifdef HOP_ENABLE
+HopTx hop;
+#endif
     
 /**
  * @brief Inicializações principais (ADC, PWM, entradas e rádio).
  */
 void setup() {
-    timer0_setup();
+    timer1_setup();
     
     adc_setup();
     pwm_setup();
@@ -138,33 +654,143 @@ void setup() {
     DDRC &= ~((1<<JS) | (1<<TRIGGER));
     PORTC |= ((1<<JS) | (1<<TRIGGER));
 
-    // Rádio
-    nrf24_begin(9, 10, RF24_SPI_SPEED);
-    nrf24_openWritingPipe(address);
-    nrf24_stopListening();
+    wait_ms(5);  // pull-up estabilizar antes de ler o JS
+    uint32_t cal_us = 0;  // a calibração espera o usuário: fica fora do restart_us
+    if (!(PINC & (1<<JS))) {
+        cal_us = timer1_us();
+        stick_calibrate();
+        cal_us = timer1_us() - cal_us;
+    }
+    stick_load();
+
+    // Rádio: depois de um reset com o rádio ainda alimentado, nada é regravado
+    uint32_t t0 = timer1_us();
+    Nrf24Config radio = radio_config;
+    txbox_begin(&txbox, FRAME_REDUNDANCY);
+    next_send = ticks_ms();
+    power.window = next_send;
+#if DORMANT_S > 0
+    still_since = next_send;
+#endif
+#ifdef HOP_ENABLE
+    hop_init(HOP_SEED);
+    hop_tx_begin(&hop, next_send);
+    radio.channel = hop_channel(hop.index);
+#endif
+    boot.warm = nrf24_begin_config(9, 10, RF24_SPI_SPEED, &radio);
+    boot.channel = radio.channel;
+    boot.radio_us = timer1_us() - t0;
+
+    reset_stats.restart_us = timer1_us() - cal_us;
+    wdog_start(WDOG_TIMEOUT, TASK_ALL);
+
+#ifdef TELEM_ENABLE
+    uart_begin();
+    static_assert(RESET_CAUSES == sizeof(((TelemReset *)0)->count) / 2);
+    TelemReset r = {.cause = reset_stats.cause, .stalled = reset_stats.stalled, .restart_us = reset_stats.restart_us};
+    for (uint8_t i = 0; i < RESET_CAUSES; i++) r.count[i] = reset_stats.count[i];
+    TELEM(TELEM_RESET, r);
+#endif
+#ifdef HIST_ENABLE
+    period_start = hist_clock();
+#endif
+}
+
+#ifdef TELEM_ENABLE
+/**
+ * @brief Comandos de um byte vindos do PC pela serial (RX, PD0).
+ *
+ * h envia os histogramas e z os zera (HIST_ENABLE); t envia o rastro
+ * (TRACE_ENABLE). Os envios andam um registro por envio do laço.
+ */
+static void serial_commands(void) {
+    switch (uart_read()) {
+#ifdef HIST_ENABLE
+    case 'h': hist_dump(); break;
+    case 'z': hist_clear(hist); break;
+#endif
+#ifdef TRACE_ENABLE
+    case 't': trace_dump(&trace); break;
+#endif
+    }
 }
+#endif
 
 /**
  * @brief Loop principal: lê controles, aplica deadzone, envia por RF e atualiza LEDs.
  */
 void loop() {
     Controls gamepad;
+    HIST_LAP(HIST_PERIOD, period_start);
+    HIST_START(t);
+    TRACE(TR_LOOP, 0);
 
-    gamepad.x = (int8_t) map(adc_read(JX), 0, 1023, -127, 127);
-    gamepad.y = (int8_t) map(adc_read(JY), 0, 1023, -127, 127);
+    // Calibração e DEADZONE já estão nas tabelas
+    gamepad.x = stick_lut[0][adc_read(JX) >> STICK_LUT_SHIFT];
+    TRACE(TR_ADC, JX);
+    gamepad.y = stick_lut[1][adc_read(JY) >> STICK_LUT_SHIFT];
+    TRACE(TR_ADC, JY);
+    HIST_LAP(HIST_READ, t);
 
     gamepad.sw = (int8_t)(!(PINC & (1<<JS)));
     gamepad.trigger = (int8_t)(!(PINC & (1<<TRIGGER)));
+    wdog_done(TASK_READ);
 
-    // DEADZONE
-    if (gamepad.x > -DEADZONE && gamepad.x < DEADZONE) gamepad.x = 0;
-    if (gamepad.y > -DEADZONE && gamepad.y < DEADZONE) gamepad.y = 0;
+#if defined(TRACE_ENABLE) || defined(HIST_ENABLE)
+    // JS e TRIGGER apertados juntos: envia o rastro e os histogramas
+    static uint8_t both_prev = 0;
+    uint8_t both = gamepad.sw && gamepad.trigger;
+    if (both && !both_prev) {
+#ifdef TRACE_ENABLE
+        trace_dump(&trace);
+#endif
+#ifdef HIST_ENABLE
+        hist_dump();
+#endif
+    }
+    both_prev = both;
+#endif
 
-    uint8_t ok = nrf24_write(&gamepad, sizeof(gamepad));
+#ifdef HOP_ENABLE
+    if (hop_tx_poll(&hop, ticks_ms())) nrf24_setChannel(hop_channel(hop.index));
+#endif
+
+    // A amostra nova vai para o ar já, ou toma o lugar da que esperava
+    uint16_t now = ticks_ms();
+    TRACE(TR_TX_START, txbox.link.seq);
+#ifdef HIST_ENABLE
+    tx_start = hist_clock();
+#endif
+    txbox_put(&txbox, &gamepad, now);
+    radio_poll();
+    wdog_done(TASK_SEND);
 
-    pwm_write(LED2, ok);
     pwm_write(LED1, abs_int(gamepad.y) * 2);
 
+    power_account(now);
+#ifdef TELEM_ENABLE
+    serial_commands();
+#endif
+#ifdef TRACE_ENABLE
+    trace_poll(&trace, now);
+#endif
+#ifdef HIST_ENABLE
+    hist_poll(hist, now);
+#endif
+#if DORMANT_S > 0
+    if (gamepad.x || gamepad.y || gamepad.sw || gamepad.trigger) {
+        still_since = now;
+    } else if ((uint16_t)(now - still_since) >= DORMANT_S * 1000u) {
+        power_dormant();
+        still_since = next_send = ticks_ms();
+        power = (PowerStats){.window = still_since};
+#ifdef HIST_ENABLE
+        period_start = hist_clock();  // o tempo dormente não é um período
+#endif
+    }
+#endif
+
+    TRACE(TR_LOOP_END, 0);
     delay20ms();
 }
 
@@ -172,6 +798,7 @@ void loop() {
  * @brief Função principal do firmware.
  */
 int main() {
+    wdog_boot();
     setup();
     while (1) loop();
 }
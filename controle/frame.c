@@ -0,0 +1,175 @@
+#include "frame.h"
+
+#define FRAME_REJECT_RESET 8   // rejeições seguidas até aceitar como reinício
+#define FRAME_LAT_WINDOW   128 // quadros por janela do mínimo de atraso
+
+/**
+ * @brief Empacota os controles no quadro do rádio.
+ * @param seq número de sequência do envio.
+ * @param now relógio do controle em ms.
+ */
+void frame_encode(Frame *f, const Controls *c, uint8_t seq, uint16_t now) {
+  uint8_t buttons = 0;
+  if (c->sw)      buttons |= FRAME_BTN_SW;
+  if (c->trigger) buttons |= FRAME_BTN_TRIGGER;
+
+  f->head = (FRAME_VERSION << FRAME_VER_SHIFT) | buttons;
+  f->seq = seq;
+  f->x = c->x;
+  f->y = c->y;
+  f->ts = (uint8_t)now;
+}
+
+#if FRAME_REDUNDANCY > 0
+static int8_t sat8(int16_t v) {
+  if (v > 127) return 127;
+  if (v < -127) return -127;
+  return (int8_t)v;
+}
+#endif
+
+void frame_tx_begin(FrameTx *t, uint8_t depth) {
+  *t = (FrameTx){0};
+  t->depth = depth > FRAME_REDUNDANCY ? FRAME_REDUNDANCY : depth;
+}
+
+/**
+ * @brief Empacota a amostra atual e as t->depth anteriores.
+ *
+ * As amostras anteriores vão como diferença em relação à atual. Diferenças
+ * maiores que ±127 (manche de um extremo ao outro em um período) saturam e a
+ * reconstrução fica aproximada.
+ */
+void frame_tx_encode(FrameTx *t, Frame *f, const Controls *c, uint16_t now) {
+  frame_encode(f, c, t->seq++, now);
+
+#if FRAME_REDUNDANCY > 0
+  f->head |= t->depth << FRAME_HIST_SHIFT;
+  f->hist_btn = 0;
+  for (uint8_t k = 0; k < FRAME_REDUNDANCY; k++) {
+    const Controls *p = &t->hist[k];
+    f->hist[k][0] = sat8(c->x - p->x);
+    f->hist[k][1] = sat8(c->y - p->y);
+    if (p->sw)      f->hist_btn |= FRAME_BTN_SW << (2 * k);
+    if (p->trigger) f->hist_btn |= FRAME_BTN_TRIGGER << (2 * k);
+  }
+
+  // hist[0] passa a ser a amostra atual
+  for (uint8_t k = FRAME_REDUNDANCY; k > 0; k--) t->hist[k] = t->hist[k - 1];
+#endif
+  t->hist[0] = *c;
+}
+
+/**
+ * @brief Desempacota o quadro do rádio.
+ * @return 1 se a versão é conhecida, 0 caso contrário (c não é alterado).
+ */
+uint8_t frame_decode(const Frame *f, Controls *c) {
+  if ((f->head >> FRAME_VER_SHIFT) != FRAME_VERSION) return 0;
+
+  c->x = f->x;
+  c->y = f->y;
+  c->sw = (f->head & FRAME_BTN_SW) ? 1 : 0;
+  c->trigger = (f->head & FRAME_BTN_TRIGGER) ? 1 : 0;
+  return 1;
+}
+
+/**
+ * @brief Reconstrói a amostra seq-k a partir do histórico do quadro.
+ * @param k 1 para a amostra anterior, até o tamanho do histórico.
+ * @return 1 se o quadro carrega essa amostra.
+ */
+uint8_t frame_history(const Frame *f, uint8_t k, Controls *c) {
+#if FRAME_REDUNDANCY > 0
+  uint8_t depth = (f->head & FRAME_HIST_MASK) >> FRAME_HIST_SHIFT;
+  if (k < 1 || k > depth || k > FRAME_REDUNDANCY) return 0;
+
+  uint8_t buttons = f->hist_btn >> (2 * (k - 1));
+  c->x = sat8(f->x - f->hist[k - 1][0]);
+  c->y = sat8(f->y - f->hist[k - 1][1]);
+  c->sw = (buttons & FRAME_BTN_SW) ? 1 : 0;
+  c->trigger = (buttons & FRAME_BTN_TRIGGER) ? 1 : 0;
+  return 1;
+#else
+  (void)f; (void)k; (void)c;
+  return 0;
+#endif
+}
+
+void frame_rx_begin(FrameRx *r) {
+  *r = (FrameRx){0};
+}
+
+/**
+ * @brief Atualiza a latência de um sentido.
+ *
+ * Os relógios não são sincronizados, então o atraso medido (chegada - ts)
+ * inclui um deslocamento desconhecido. A latência reportada é o atraso acima
+ * do menor atraso visto; o mínimo é renovado a cada janela para acompanhar a
+ * deriva entre os cristais.
+ */
+static void latency_update(FrameRx *r, uint8_t ts, uint16_t now) {
+  uint8_t delay = (uint8_t)now - ts;
+  int8_t rel = (int8_t)(delay - r->lat_base);
+
+  if (!r->valid || rel < 0) {
+    r->lat_base = delay;
+    r->lat_win = 0;
+    rel = 0;
+  }
+  r->latency = rel;
+
+  if ((uint8_t)rel < r->lat_win || r->lat_count == 0) r->lat_win = rel;
+  if (++r->lat_count >= FRAME_LAT_WINDOW) {
+    r->lat_base += r->lat_win;
+    r->lat_count = 0;
+  }
+}
+
+/**
+ * @brief Decide se um quadro recebido deve ser usado.
+ * @return 1 para quadros novos; 0 para duplicados, fora de ordem ou de outra versão.
+ *
+ * Um quadro duplicado aparece quando o ACK se perde e o controle retransmite.
+ * Quadros pulados ficam em r->gap; os que o histórico cobre contam como
+ * recuperados (ver frame_history()).
+ * Depois de FRAME_REJECT_RESET rejeições seguidas, assume que o controle
+ * reiniciou a sequência e volta a aceitar.
+ */
+uint8_t frame_rx_accept(FrameRx *r, const Frame *f, uint16_t now) {
+  if ((f->head >> FRAME_VER_SHIFT) != FRAME_VERSION) {
+    r->bad_version++;
+    return 0;
+  }
+
+  if (r->valid && r->rejected < FRAME_REJECT_RESET) {
+    int8_t delta = (int8_t)(f->seq - r->last_seq);
+    if (delta == 0) {
+      r->duplicated++;
+      r->rejected++;
+      return 0;
+    }
+    if (delta < 0) {
+      r->reordered++;
+      r->rejected++;
+      return 0;
+    }
+    r->gap = delta - 1;
+  } else {
+    r->gap = 0;
+  }
+
+  if (r->gap) {
+    uint8_t depth = (f->head & FRAME_HIST_MASK) >> FRAME_HIST_SHIFT;
+    uint8_t recovered = r->gap < depth ? r->gap : depth;
+    r->recovered += recovered;
+    r->lost += r->gap - recovered;
+  }
+
+  latency_update(r, f->ts, now);
+  r->valid = 1;
+  r->rejected = 0;
+  r->last_seq = f->seq;
+  r->accepted++;
+  return 1;
+}
@@ -0,0 +1,105 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <assert.h>
+
+/**
+ * @brief Estado dos controles depois de decodificado.
+ *
+ * x e y variam de -127 a 127.
+ * sw e trigger são botões (0 ou 1).
+ */
+typedef struct {
+  int8_t x;
+  int8_t y;
+  int8_t sw;
+  int8_t trigger;
+} Controls;
+static_assert(sizeof(Controls) == 4);
+
+/*** CONFIGURAÇÃO (precisa ser igual no carrinho e no controle) ***/
+//#define FRAME_REDUNDANCY 3 // Amostras anteriores repetidas em cada quadro (0 a 4)
+
+#ifndef FRAME_REDUNDANCY
+#define FRAME_REDUNDANCY 0
+#endif
+static_assert(FRAME_REDUNDANCY <= 4);
+
+/*
+ Quadro enviado pelo rádio (versão 1), 5 bytes + histórico:
+
+   byte 0  head  [7:5] versão  [4:2] amostras no histórico  [1] trigger  [0] sw
+   byte 1  seq   número de sequência (incrementa a cada envio)
+   byte 2  x     eixo X (-127..127)
+   byte 3  y     eixo Y (-127..127)
+   byte 4  ts    relógio do controle em ms (8 bits menos significativos)
+
+ Com FRAME_REDUNDANCY > 0 seguem:
+
+   byte 5       hist_btn  botões das amostras anteriores, 2 bits cada (k=1 nos bits 1:0)
+   byte 6+2k-2  dx, dy    diferença entre a amostra atual e a amostra seq-k
+
+ Assim o carrinho reconstrói até FRAME_REDUNDANCY quadros perdidos a partir do
+ próximo que chegar, sem esperar retransmissões.
+*/
+#define FRAME_VERSION  1
+#define FRAME_VER_SHIFT 5
+#define FRAME_HIST_SHIFT 2
+#define FRAME_HIST_MASK  (0x07 << FRAME_HIST_SHIFT)
+#define FRAME_BTN_SW      (1 << 0)
+#define FRAME_BTN_TRIGGER (1 << 1)
+
+typedef struct {
+  uint8_t head;
+  uint8_t seq;
+  int8_t  x;
+  int8_t  y;
+  uint8_t ts;
+#if FRAME_REDUNDANCY > 0
+  uint8_t hist_btn;
+  int8_t  hist[FRAME_REDUNDANCY][2];
+#endif
+} Frame;
+static_assert(sizeof(Frame) == 5 + (FRAME_REDUNDANCY ? 1 + 2 * FRAME_REDUNDANCY : 0));
+
+/**
+ * @brief Estado do transmissor: sequência e amostras anteriores.
+ */
+typedef struct {
+  uint8_t  seq;
+  uint8_t  depth;  // amostras anteriores enviadas (até FRAME_REDUNDANCY)
+  Controls hist[FRAME_REDUNDANCY + 1];
+} FrameTx;
+
+/**
+ * @brief Estado do receptor: filtro de duplicados e estimativa de latência.
+ */
+typedef struct {
+  uint8_t  valid;      // já recebeu algum quadro
+  uint8_t  last_seq;   // último número de sequência aceito
+  uint8_t  rejected;   // rejeições seguidas (detecta reinício do controle)
+  uint8_t  lat_base;   // menor atraso observado (ms, mod 256)
+  uint8_t  lat_win;    // menor atraso relativo da janela atual
+  uint8_t  lat_count;  // quadros na janela atual
+  uint8_t  latency;    // atraso do último quadro acima do mínimo (ms)
+  uint8_t  gap;        // quadros perdidos logo antes do último aceito
+  uint16_t accepted;
+  uint16_t duplicated;
+  uint16_t reordered;
+  uint16_t lost;       // comandos perdidos sem recuperação
+  uint16_t recovered;  // comandos perdidos reconstruídos pelo histórico
+  uint16_t bad_version;
+} FrameRx;
+
+void    frame_encode(Frame *f, const Controls *c, uint8_t seq, uint16_t now);
+uint8_t frame_decode(const Frame *f, Controls *c);
+uint8_t frame_history(const Frame *f, uint8_t k, Controls *c);
+
+void    frame_tx_begin(FrameTx *t, uint8_t depth);
+void    frame_tx_encode(FrameTx *t, Frame *f, const Controls *c, uint16_t now);
+
+void    frame_rx_begin(FrameRx *r);
+uint8_t frame_rx_accept(FrameRx *r, const Frame *f, uint16_t now);
+
+#endif
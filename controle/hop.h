@@ -0,0 +1,58 @@
+#ifndef HOP_H
+#define HOP_H
+
+#include <stdint.h>
+
+/*** CONFIGURAÇÃO (precisa ser igual no carrinho e no controle) ***/
+//#define HOP_ENABLE       // Ativa o salto de frequência
+
+#define HOP_SEED      0xACE1 // Semente da sequência de canais
+#define HOP_LEN       16     // Quantidade de canais na sequência
+#define HOP_CH_FIRST  2      // Primeiro canal permitido (2402 MHz)
+#define HOP_CH_LAST   81     // Último canal permitido (2481 MHz)
+#define HOP_MIN_STEP  6      // Distância mínima entre dois canais seguidos
+
+#define HOP_PERIOD_MS 20     // Intervalo entre envios do controle
+#define HOP_SLOTS     4      // Envios por canal
+#define HOP_DWELL_MS  (HOP_PERIOD_MS * HOP_SLOTS)
+
+#define HOP_RESYNC    3      // Canais seguidos sem pacote até voltar a procurar
+
+/**
+ * @brief Estados do sincronismo do receptor.
+ */
+typedef enum {HOP_SEARCH, HOP_TRACK} HopState;
+
+/**
+ * @brief Lado transmissor: segue a sequência pelo relógio local.
+ */
+typedef struct {
+  uint8_t  index;  // posição atual na sequência
+  uint16_t start;  // instante (ms) em que entrou no canal atual
+} HopTx;
+
+/**
+ * @brief Lado receptor: segue a fase do transmissor pelos pacotes recebidos.
+ */
+typedef struct {
+  uint8_t  index;    // posição atual na sequência
+  uint8_t  state;    // HOP_SEARCH ou HOP_TRACK
+  uint8_t  heard;    // recebeu algum pacote no canal atual
+  uint8_t  missed;   // canais seguidos sem nenhum pacote
+  uint16_t start;    // instante estimado do primeiro envio no canal atual
+  uint16_t first_rx; // primeiro pacote da rajada (HOP_SEARCH)
+  uint16_t last_rx;  // instante do último pacote
+  uint16_t resyncs;  // quantas vezes perdeu o sincronismo
+} HopRx;
+
+void    hop_init(uint16_t seed);
+uint8_t hop_channel(uint8_t index);
+
+void    hop_tx_begin(HopTx *h, uint16_t now);
+uint8_t hop_tx_poll(HopTx *h, uint16_t now);
+
+void    hop_rx_begin(HopRx *h);
+void    hop_rx_packet(HopRx *h, uint16_t now);
+uint8_t hop_rx_poll(HopRx *h, uint16_t now);
+
+#endif
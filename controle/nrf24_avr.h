@@ -5,17 +5,51 @@
 #include "nRF24L01.h"
 #include "RF24_config.h"
 
+// Full radio setup for nrf24_begin_config()
+typedef struct {
+    uint8_t channel;
+    uint8_t payload;     // static payload size, 1..32
+    uint8_t retries;     // SETUP_RETR value: (delay << ARD) | count
+    uint8_t rf_setup;    // RF_SETUP value, see NRF24_RF_SETUP()
+    uint8_t feature;     // FEATURE value: EN_DPL, EN_ACK_PAY, EN_DYN_ACK
+    uint8_t dynpd;       // DYNPD value: pipes with dynamic payload length
+    uint8_t rx;          // 1 = receiver (PRIM_RX), 0 = transmitter
+    uint8_t address[5];  // pipe 0 (and TX_ADDR when transmitting)
+} Nrf24Config;
+
+typedef enum { RF24_1MBPS, RF24_2MBPS, RF24_250KBPS } rf24_datarate_e;
+
+// RF_SETUP for a data rate (rf24_datarate_e) and PA level (0 = -18dBm .. 3 = 0dBm);
+// the power-on value is NRF24_RF_SETUP(RF24_2MBPS, 3)
+#define NRF24_RF_SETUP(rate, pa) \
+    (((rate) == RF24_250KBPS ? 1<<RF_DR_LOW : (rate) == RF24_2MBPS ? 1<<RF_DR_HIGH : 0) | \
+     ((pa) & 3) << RF_PWR_LOW)
+
 // API (funções diretas)
-void nrf24_init_hwspi(void); // configura SPI hardware
+void nrf24_init_hwspi(void); // configura SPI hardware (só no AVR)
 void nrf24_begin(uint8_t ce_pin, uint8_t csn_pin, uint32_t spi_speed_hz);
+uint8_t nrf24_begin_config(uint8_t ce_pin, uint8_t csn_pin, uint32_t spi_speed_hz, const Nrf24Config *c); // 1 = warm radio, nothing rewritten
 void nrf24_setChannel(uint8_t channel);
+uint8_t nrf24_getChannel(void); // cached, no SPI after the first call
 void nrf24_setPayloadSize(uint8_t size);
+void nrf24_setDataRate(uint8_t rate); // rf24_datarate_e; power-on default is 2Mbps (nrf24_begin_config sets rf_setup)
+void nrf24_setRetries(uint8_t delay, uint8_t count); // SETUP_RETR: (delay+1)*250us, 0..15 retries
 void nrf24_openWritingPipe(const uint8_t *address); // address length = 5
-void nrf24_openReadingPipe(uint8_t pipe, const uint8_t *address); // only pipe 0 used here
+void nrf24_openReadingPipe(uint8_t pipe, const uint8_t *address); // also enables the pipe; 2..5 take only address[0]
+void nrf24_setTxAddress(const uint8_t *address); // TX_ADDR only, for sends without ACK
+void nrf24_setAutoAck(uint8_t pipes); // EN_AA bit mask
+void nrf24_enableDynamicAck(void); // needed by nrf24_startWrite(..., no_ack = 1); or EN_DYN_ACK in Nrf24Config.feature
 void nrf24_startListening(void);
-void nrf24_stopListening(void);
+void nrf24_stopListening(void); // no-op (besides CE low) when already in TX
+void nrf24_powerDown(void); // ~0.9uA, registers kept
+void nrf24_powerUp(void);   // waits the 1.5ms crystal start-up
 uint8_t nrf24_write(const void *buf, uint8_t len);
+void nrf24_startWrite(const void *buf, uint8_t len, uint8_t no_ack); // returns at once
+uint8_t nrf24_txPoll(void); // 0 = still sending, 1 = sent, 2 = MAX_RT (TX FIFO flushed)
+void nrf24_cancelWrite(void); // stops a nrf24_startWrite() still retrying and drops the TX FIFO
+uint8_t nrf24_retransmits(void); // of the last payload sent (or given up)
 uint8_t nrf24_available(void);
+uint8_t nrf24_availablePipe(uint8_t *pipe); // RX FIFO not empty; pipe of the next payload
 void nrf24_read(void *buf, uint8_t len);
 void nrf24_flush_tx(void);
 void nrf24_flush_rx(void);
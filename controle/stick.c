@@ -0,0 +1,60 @@
+#include <stddef.h>
+#include "stick.h"
+
+/**
+ * @brief Eixo ideal: 0..1023 com centro em 512 (o map() antigo).
+ */
+void stick_defaults(StickCal *c) {
+  for (uint8_t i = 0; i < 2; i++) c->axis[i] = (AxisCal){0, 512, 1023};
+  stick_seal(c);
+}
+
+static uint8_t checksum(const StickCal *c) {
+  const uint8_t *p = (const uint8_t *)c;
+  uint8_t sum = 0;
+  for (uint8_t i = 0; i < offsetof(StickCal, sum); i++) sum += p[i];
+  return ~sum;
+}
+
+/**
+ * @brief Preenche magic e soma antes de gravar.
+ */
+void stick_seal(StickCal *c) {
+  c->magic = STICK_MAGIC;
+  c->sum = checksum(c);
+}
+
+/**
+ * @brief Confere formato, soma e cursos mínimos.
+ * @return 1 se a calibração pode ser usada (EEPROM apagada lê 0xFF e falha aqui).
+ */
+uint8_t stick_valid(const StickCal *c) {
+  if (c->magic != STICK_MAGIC || c->sum != checksum(c)) return 0;
+  for (uint8_t i = 0; i < 2; i++) {
+    const AxisCal *a = &c->axis[i];
+    if (a->max > 1023) return 0;
+    if (a->center < a->min + STICK_MIN_SPAN || a->max < a->center + STICK_MIN_SPAN) return 0;
+  }
+  return 1;
+}
+
+/**
+ * @brief Monta a tabela ADC >> STICK_LUT_SHIFT -> -127..127 de um eixo.
+ *
+ * Cada lado do centro é escalado pelo próprio curso, então um manche
+ * descentrado ainda chega a ±127 nos dois sentidos. A zona morta (na escala de
+ * saída) é aplicada em volta do centro calibrado e o resto do curso é
+ * reescalado, sem salto de 0 para deadzone na borda dela.
+ */
+void stick_build(int8_t lut[STICK_LUT_SIZE], const AxisCal *a, uint8_t deadzone) {
+  for (uint16_t i = 0; i < STICK_LUT_SIZE; i++) {
+    int32_t adc = (i << STICK_LUT_SHIFT) + (1 << STICK_LUT_SHIFT) / 2;
+    int32_t d = adc - a->center;
+    int32_t v = d >= 0 ? d * 127 / (a->max - a->center) : d * 127 / (a->center - a->min);
+    int32_t mag = v < 0 ? -v : v;
+
+    if (mag > 127) mag = 127;
+    mag = mag < deadzone ? 0 : (mag - deadzone) * 127 / (127 - deadzone);
+    lut[i] = (int8_t)(v < 0 ? -mag : mag);
+  }
+}
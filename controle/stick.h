@@ -0,0 +1,36 @@
+#ifndef STICK_H
+#define STICK_H
+
+#include <stdint.h>
+#include <assert.h>
+
+#define STICK_LUT_SHIFT 2                      // ADC de 10 bits -> índice de 8 bits
+#define STICK_LUT_SIZE  (1024 >> STICK_LUT_SHIFT)
+#define STICK_MIN_SPAN  100                    // menor curso aceito de cada lado do centro (ADC)
+#define STICK_MAGIC     0xC5                   // muda se o formato de StickCal mudar
+
+/**
+ * @brief Leituras do ADC nos extremos e no centro de um eixo.
+ */
+typedef struct {
+  uint16_t min;
+  uint16_t center;
+  uint16_t max;
+} AxisCal;
+
+/**
+ * @brief Calibração dos dois eixos, como fica gravada na EEPROM.
+ */
+typedef struct {
+  AxisCal axis[2];  // 0 = X, 1 = Y
+  uint8_t magic;
+  uint8_t sum;      // complemento da soma dos bytes anteriores
+} StickCal;
+static_assert(sizeof(StickCal) == 14);
+
+void    stick_defaults(StickCal *c);
+void    stick_seal(StickCal *c);
+uint8_t stick_valid(const StickCal *c);
+void    stick_build(int8_t lut[STICK_LUT_SIZE], const AxisCal *a, uint8_t deadzone);
+
+#endif
@@ -0,0 +1,65 @@
+#include "txbox.h"
+#include "nrf24_avr.h"
+
+static uint8_t stale(uint16_t since, uint16_t now) {
+  return (uint16_t)(now - since) >= TXBOX_DEADLINE_MS;
+}
+
+/**
+ * @brief Esvazia a caixa; depth é o histórico de cada quadro (frame_tx_begin).
+ */
+void txbox_begin(TxBox *b, uint8_t depth) {
+  *b = (TxBox){0};
+  frame_tx_begin(&b->link, depth);
+}
+
+/**
+ * @brief Entrega a amostra mais nova (lida em now); ela vai ao ar no próximo
+ * txbox_poll() com o rádio livre.
+ */
+void txbox_put(TxBox *b, const Controls *c, uint16_t now) {
+  if (b->full) b->superseded++;
+  b->slot = *c;
+  b->slot_ms = now;
+  b->full = 1;
+}
+
+/**
+ * @brief Confere o envio em andamento e, com o rádio livre, manda a vaga.
+ *
+ * Sem envio no ar e sem vaga ocupada não fala com o rádio.
+ *
+ * @return TxBoxResult do envio que terminou nesta chamada, TXBOX_BUSY se
+ *         ainda há um no ar, ou TXBOX_IDLE.
+ */
+uint8_t txbox_poll(TxBox *b, uint16_t now) {
+  uint8_t r = TXBOX_IDLE;
+
+  if (b->busy) {
+    uint8_t s = nrf24_txPoll();
+    if (s) {
+      r = s == 1 ? TXBOX_SENT : TXBOX_FAILED;
+    } else if (stale(b->air_ms, now)) {
+      nrf24_cancelWrite();
+      b->expired++;
+      r = TXBOX_EXPIRED;
+    } else {
+      return TXBOX_BUSY;
+    }
+    b->busy = 0;
+  }
+
+  if (b->full) {
+    b->full = 0;
+    if (stale(b->slot_ms, now)) {
+      b->expired++;
+    } else {
+      Frame f;
+      frame_tx_encode(&b->link, &f, &b->slot, b->slot_ms);
+      nrf24_startWrite(&f, sizeof(f), 0);
+      b->air_ms = b->slot_ms;
+      b->busy = 1;
+    }
+  }
+  return r;
+}
@@ -0,0 +1,49 @@
+#ifndef TXBOX_H
+#define TXBOX_H
+
+#include <stdint.h>
+#include "frame.h"
+
+/*
+ Caixa de envio do controle: uma vaga só, com a amostra mais nova, na frente
+ de um envio sem espera (nrf24_startWrite). Uma amostra nova toma o lugar da
+ que ainda não foi para o ar, e um quadro que passou de TXBOX_DEADLINE_MS
+ desde a leitura do manche sai do rádio com FLUSH_TX em vez de continuar
+ nas retransmissões: o rádio só carrega dados com até esse atraso.
+
+ A amostra só vira quadro (frame_tx_encode) quando vai ao ar: o seq e o
+ histórico andam só com os envios, então uma amostra trocada ou vencida na
+ vaga não aparece no carrinho como quadro perdido.
+
+ O laço entrega cada amostra com txbox_put() e chama txbox_poll() sempre
+ que pode (inclusive esperando a grade); o resultado de cada envio chega
+ numa dessas chamadas.
+*/
+
+/*** CONFIGURAÇÃO ***/
+#define TXBOX_DEADLINE_MS 10 // Idade máxima de um quadro no ar ou esperando por ele
+
+typedef enum {
+  TXBOX_IDLE,     // nada terminou nesta chamada
+  TXBOX_BUSY,     // quadro no ar
+  TXBOX_SENT,     // TX_DS: o carrinho confirmou (ACK)
+  TXBOX_FAILED,   // MAX_RT: sem ACK depois das retransmissões (ou logo, com ARC = 0)
+  TXBOX_EXPIRED,  // cortado pelo prazo (FLUSH_TX)
+} TxBoxResult;
+
+typedef struct {
+  FrameTx  link;        // seq e amostras anteriores dos quadros que foram ao ar
+  Controls slot;        // amostra esperando o rádio
+  uint16_t slot_ms;     // leitura da amostra da vaga
+  uint16_t air_ms;      // leitura da amostra que está no ar
+  uint8_t  full;        // vaga ocupada
+  uint8_t  busy;        // envio em andamento
+  uint16_t superseded;  // amostras trocadas por uma mais nova antes de ir ao ar
+  uint16_t expired;     // quadros vencidos, no ar ou na vaga
+} TxBox;
+
+void    txbox_begin(TxBox *b, uint8_t depth);
+void    txbox_put(TxBox *b, const Controls *c, uint16_t now);
+uint8_t txbox_poll(TxBox *b, uint16_t now);
+
+#endif
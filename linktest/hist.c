@@ -0,0 +1,66 @@
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "hist.h"
+#include "telem.h"
+#include "uart.h"
+
+#define HIST_HALF (HIST_BUCKETS / 2)
+static_assert(HIST_HALF == sizeof(((TelemHist *)0)->count) / 2);
+
+static uint8_t sending = 0;  // 1 + próxima metade a enviar, 0 parado
+
+/**
+ * @brief Zera todos os histogramas (HIST_IDS) do firmware.
+ */
+void hist_clear(Hist *set) {
+  uint8_t sreg = SREG;
+  cli();
+  for (uint8_t i = 0; i < HIST_IDS; i++) set[i] = (Hist){0};
+  SREG = sreg;
+}
+
+/**
+ * @brief Começa a enviar os histogramas (o envio anda em hist_poll()).
+ */
+void hist_dump(void) {
+  if (!sending) sending = 1;
+}
+
+/**
+ * @brief Envia a próxima metade de histograma, se couber na serial.
+ *
+ * Chamar uma vez por período, na folga do laço: cada histograma vai em dois
+ * registros TELEM_HIST (buckets 0-7 e 8-15) e os vazios são pulados. Os
+ * histogramas continuam acumulando; só hist_clear() zera.
+ *
+ * @return 1 enquanto houver envio em andamento.
+ */
+uint8_t hist_poll(Hist *set, uint16_t now) {
+  while (sending) {
+    uint8_t half = sending - 1;
+    uint8_t id = half / 2, first = (half & 1) * HIST_HALF;
+    if (id >= HIST_IDS) {
+      sending = 0;
+      break;
+    }
+
+    TelemHist r = {.id = id, .first = first};
+    uint8_t sreg = SREG;
+    cli();
+    r.max = set[id].max;
+    for (uint8_t i = 0; i < HIST_HALF; i++) r.count[i] = set[id].count[first + i];
+    uint8_t empty = set[id].max == 0 && set[id].count[0] == 0;
+    SREG = sreg;
+
+    if (empty) {
+      sending += 2 - (half & 1);  // pula o histograma inteiro
+      continue;
+    }
+    // Sem espaço na serial: tenta a mesma metade no próximo período
+    if (uart_free() < TELEM_HEADER + sizeof(r) + 1) return 1;
+    telem_send(TELEM_HIST, now, &r, sizeof(r));
+    sending++;
+    return 1;
+  }
+  return 0;
+}
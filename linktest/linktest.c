@@ -0,0 +1,287 @@
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <string.h>
+#include "nrf24_avr.h"
+#include "uart.h"
+#include "telem.h"
+#include "hist.h"
+
+/*
+ Teste de enlace: duas placas com o mesmo firmware, uma compilada com LT_TX,
+ caracterizam um par de rádios e antenas antes da partida. O transmissor
+ manda pacotes numerados de LT_PAYLOAD bytes a LT_RATE_HZ, com a taxa de
+ dados, as retransmissões e o ACK configurados abaixo; o receptor conta os
+ novos, perdidos, repetidos e fora de ordem e mede o intervalo entre
+ chegadas.
+
+ Os dois mandam pela serial (USB) um TELEM_LTEST por janela de LT_REPORT_MS
+ (pacotes por segundo, perda, retransmissões, jitter) e os histogramas a
+ cada LT_HIST_REPORTS janelas, ou com h pela serial (z zera):
+  - HIST_PERIOD: começo a começo dos envios (TX) ou entre chegadas (RX);
+  - HIST_RADIO: envio até o ACK, com as retransmissões (TX), ou atraso de
+    cada pacote acima do menor da janela anterior (RX, pelos relógios dos
+    dois lados: só a variação vale, não o valor).
+ O tools/telemdecode resume as janelas e o tools/tracedecode -s os
+ histogramas.
+
+ Mesma pinagem do carrinho e da base (CE no D9, CSN no D10): roda nas
+ placas de verdade, com as antenas de verdade.
+*/
+
+/*** CONFIGURAÇÃO ***/
+//#define LT_TX                       // Transmissor; sem isto, receptor
+#define LT_CHANNEL      76
+#define LT_ADDRESS      {'N', 'O', 'D', 'E', '1'}
+#define LT_PAYLOAD      32            // Bytes por pacote (12..32)
+#define LT_RATE_HZ      500           // Pacotes por segundo no TX (0 = um logo depois do outro)
+#define LT_DATA_RATE    RF24_1MBPS    // RF24_250KBPS, RF24_1MBPS ou RF24_2MBPS (os dois lados)
+#define LT_RETRIES      ((1 << ARD) | 3) // SETUP_RETR: 500us entre tentativas, até 3 retransmissões
+#define LT_ACK          1             // 0 = envia sem ACK e sem retransmissões
+#define LT_REPORT_MS    1000          // Janela do TELEM_LTEST
+#define LT_HIST_REPORTS 10            // Histogramas a cada tantas janelas (0 = só com h)
+#define LT_REORDER      64            // seq mais para trás que isto: o TX reiniciou (ver receive())
+#define LT_LED          PC4           // Troca de estado a cada 64 pacotes
+
+#if LT_RATE_HZ
+#define LT_PERIOD_US (1000000UL / LT_RATE_HZ)
+#else
+#define LT_PERIOD_US 0UL
+#endif
+
+/**
+ * @brief Começo de cada pacote; o resto até LT_PAYLOAD é o seq repetido.
+ */
+typedef struct {
+  uint32_t seq;
+  uint32_t sent_us;    // relógio do TX no começo do envio
+  uint32_t period_us;  // grade do TX (0 = sem grade)
+} LinkTestPacket;
+static_assert(LT_PAYLOAD >= sizeof(LinkTestPacket) && LT_PAYLOAD <= 32);
+
+/**
+ * @brief Relógio de 1ms do Timer1 (CTC, contagens de 0,5us).
+ */
+#define TIMER1_TOP (F_CPU / 8 / 1000 - 1)
+volatile uint32_t ms_ticks = 0;
+ISR(TIMER1_COMPA_vect) {
+  ms_ticks++;
+}
+
+void timer1_setup(void) {
+  TCCR1A = 0;
+  TCCR1B = (1<<WGM12) | (1<<CS11);  // CTC, prescaler de 8
+  OCR1A = TIMER1_TOP;
+  TIMSK1 = (1<<OCIE1A);
+}
+
+uint32_t micros(void) {
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t t = TCNT1;
+  uint32_t ms = ms_ticks;
+  if ((TIFR1 & (1<<OCF1A)) && t < TIMER1_TOP / 2) ms++; // tick pendente
+  SREG = sreg;
+  return ms * 1000 + t / 2;
+}
+
+Hist hist[HIST_IDS];
+TelemLinkTest win;
+uint32_t jitter_sum;
+uint16_t jitter_n;
+
+/**
+ * @brief us em contagens do hist.h (0,5us), saturando em ~32ms.
+ */
+static uint16_t counts(uint32_t us) {
+  return us >= 0x8000 ? 0xFFFF : us * 2;
+}
+
+static void jitter(uint32_t us) {
+  jitter_sum += us;
+  jitter_n++;
+  if (us > win.jitter_max) win.jitter_max = us > 0xFFFF ? 0xFFFF : us;
+}
+
+void radio_setup(void) {
+  const Nrf24Config radio = {
+    LT_CHANNEL, LT_PAYLOAD, LT_RETRIES, NRF24_RF_SETUP(LT_DATA_RATE, 3),
+#ifdef LT_TX
+    LT_ACK ? 0 : 1<<EN_DYN_ACK, 0, 0,
+#else
+    0, 0, 1,
+#endif
+    LT_ADDRESS,
+  };
+  nrf24_begin_config(9, 10, RF24_SPI_SPEED, &radio);
+#ifndef LT_TX
+  nrf24_startListening();
+#endif
+}
+
+#ifdef LT_TX
+/**
+ * @brief Termina o envio em andamento e começa o próximo na hora dele.
+ *
+ * Se a grade ficou mais de um período para trás (retransmissões demais para
+ * a taxa), recomeça dela do agora em vez de mandar uma rajada.
+ */
+void transmit(void) {
+  static uint32_t seq = 0, next_us, start_us, last_start;
+  static uint8_t sending = 0, started = 0;
+
+  if (sending) {
+    uint8_t r = nrf24_txPoll();
+    if (!r) return;
+    sending = 0;
+    hist_add(&hist[HIST_RADIO], counts(micros() - start_us));
+    win.retries += nrf24_retransmits();
+    if (r == 1) win.packets++;
+    else win.lost++;
+    if (!(seq & 63)) PORTC ^= (1 << LT_LED);
+  }
+
+  uint32_t now = micros();
+  if (!started) next_us = now;
+  int32_t late = now - next_us;
+  if (LT_PERIOD_US) {
+    if (late < 0) return;
+    jitter(late);
+    next_us += LT_PERIOD_US;
+    if (late > (int32_t)LT_PERIOD_US) next_us = now + LT_PERIOD_US;
+  }
+  if (started) hist_add(&hist[HIST_PERIOD], counts(now - last_start));
+  started = 1;
+  last_start = now;
+
+  uint8_t buf[LT_PAYLOAD];
+  LinkTestPacket p = {seq, now, LT_PERIOD_US};
+  memset(buf, (uint8_t)seq, sizeof(buf));
+  memcpy(buf, &p, sizeof(p));
+  seq++;
+  start_us = micros();
+  nrf24_startWrite(buf, sizeof(buf), !LT_ACK);
+  sending = 1;
+}
+#else
+uint32_t min_delay, min_next = UINT32_MAX;  // menor atraso da janela anterior e desta
+
+/**
+ * @brief Lê tudo o que estiver na FIFO de RX e classifica pelo seq.
+ *
+ * O atraso de cada pacote (chegada menos sent_us) mistura os dois relógios;
+ * só a diferença para o menor atraso recente é latência. O mínimo é o da
+ * janela anterior, para que a deriva entre os cristais (~50ppm) não se
+ * acumule no histograma.
+ */
+void receive(void) {
+  static uint32_t last_seq, last_us;
+  static uint8_t started = 0;
+
+  while (nrf24_availablePipe(NULL)) {
+    uint32_t now = micros();
+    uint8_t buf[LT_PAYLOAD];
+    LinkTestPacket p;
+    nrf24_read(buf, sizeof(buf));
+    memcpy(&p, buf, sizeof(p));
+
+    int32_t ahead = p.seq - last_seq;
+    // O TX reiniciou: seq muito para trás, ou para trás depois de uma janela
+    // inteira sem nada (o TX religado logo no começo volta o seq pouco)
+    if (started && ahead <= 0 &&
+        (ahead < -LT_REORDER || now - last_us >= LT_REPORT_MS * 1000UL)) started = 0;
+    if (started && ahead == 0) {
+      win.dup++;
+      continue;
+    }
+    if (started && ahead < 0) {
+      win.reordered++;
+      continue;
+    }
+
+    uint32_t delay = now - p.sent_us;
+    if (!started || (int32_t)(delay - min_delay) < 0) min_delay = delay;
+    if (min_next == UINT32_MAX || (int32_t)(delay - min_next) < 0) min_next = delay;
+    hist_add(&hist[HIST_RADIO], counts(delay - min_delay));
+
+    if (started) {
+      win.lost += ahead - 1;
+      hist_add(&hist[HIST_PERIOD], counts(now - last_us));
+      if (p.period_us) {
+        int32_t d = (now - last_us) - ahead * p.period_us;
+        jitter(d < 0 ? -d : d);
+      }
+    }
+    win.packets++;
+    started = 1;
+    last_seq = p.seq;
+    last_us = now;
+    if (!(p.seq & 63)) PORTC ^= (1 << LT_LED);
+  }
+}
+#endif
+
+/**
+ * @brief Fecha a janela: TELEM_LTEST e, de vez em quando, os histogramas.
+ */
+void report(uint16_t now, uint16_t window_ms) {
+  static uint8_t windows = 0;
+
+  win.window_ms = window_ms;
+  win.jitter_avg = jitter_n ? jitter_sum / jitter_n : 0;
+#ifdef LT_TX
+  win.tx = 1;
+#endif
+  win.payload = LT_PAYLOAD;
+  win.data_rate = LT_DATA_RATE;
+  win.channel = LT_CHANNEL;
+  telem_send(TELEM_LTEST, now, &win, sizeof(win));
+  win = (TelemLinkTest){0};
+  jitter_sum = 0;
+  jitter_n = 0;
+#ifndef LT_TX
+  // O mínimo desta janela vale para a próxima
+  if (min_next != UINT32_MAX) min_delay = min_next;
+  min_next = UINT32_MAX;
+#endif
+
+  if (LT_HIST_REPORTS && ++windows >= LT_HIST_REPORTS) {
+    windows = 0;
+    hist_dump();
+  }
+}
+
+int main(void) {
+  DDRC |= (1 << LT_LED);
+  timer1_setup();
+  uart_begin();
+  sei();
+  radio_setup();
+
+  uint32_t window_start = ms_ticks;
+  while (1) {
+#ifdef LT_TX
+    transmit();
+#else
+    receive();
+#endif
+
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t now = ms_ticks;
+    SREG = sreg;
+    if (now - window_start >= LT_REPORT_MS) {
+      report(now, now - window_start);
+      window_start = now;
+    }
+    hist_poll(hist, now);
+
+    switch (uart_read()) {
+    case 'h': hist_dump(); break;
+    case 'z': hist_clear(hist); break;
+    }
+  }
+}
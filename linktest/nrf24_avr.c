@@ -0,0 +1,91 @@
+#define F_CPU 16000000UL
+#include <avr/io.h>
+#include <util/delay.h>
+#include "nrf24_avr.h"
+#include "nrf24_hal.h"
+
+/* ---------- Arduino-style digital pin to AVR port helpers (UNO mapping) ----------
+ D0-D7  -> PORTD (PD0..PD7)
+ D8-D13 -> PORTB (PB0..PB5)
+ A0-A5  -> PORTC (PC0..PC5)  (if needed)
+---------------------------------------------------------------------------------*/
+
+static inline void pinMode_d(uint8_t dpin, uint8_t mode) {
+    if (dpin <= 7) {
+        if (mode) DDRD |= (1 << dpin); else DDRD &= ~(1 << dpin);
+    } else if (dpin <= 13) {
+        uint8_t b = dpin - 8;
+        if (mode) DDRB |= (1 << b); else DDRB &= ~(1 << b);
+    } else { /* not handled */ }
+}
+
+static inline void digitalWrite_d(uint8_t dpin, uint8_t val) {
+    if (dpin <= 7) {
+        if (val) PORTD |= (1 << dpin); else PORTD &= ~(1 << dpin);
+    } else if (dpin <= 13) {
+        uint8_t b = dpin - 8;
+        if (val) PORTB |= (1 << b); else PORTB &= ~(1 << b);
+    }
+}
+
+static inline uint8_t digitalRead_d(uint8_t dpin) {
+    if (dpin <= 7) {
+        return (PIND >> dpin) & 1;
+    } else if (dpin <= 13) {
+        uint8_t b = dpin - 8;
+        return (PINB >> b) & 1;
+    }
+    return 0;
+}
+
+/* SPI hardware helpers */
+static void spi_init(void) {
+    // MOSI (PB3) output, SCK (PB5) output, SS (PB2) output as CSN default
+    DDRB |= (1<<PB3)|(1<<PB5)|(1<<PB2);
+    // Enable SPI, Master, set clock rate fck/2 (SPI2X=1, SPR0=0 SPR1=0)
+    SPCR = (1<<SPE)|(1<<MSTR);
+    SPSR = (1<<SPI2X);
+}
+
+static uint8_t spi_transfer(uint8_t data) {
+    SPDR = data;
+    while(!(SPSR & (1<<SPIF)));
+    return SPDR;
+}
+
+/* nRF control pins */
+static uint8_t _ce_pin = 8;
+static uint8_t _csn_pin = 10;
+
+void nrf24_init_hwspi(void) {
+    spi_init();
+}
+
+/*
+ HAL for nrf24.c. The SPI always runs at fck/2 (8MHz, the nRF24L01+ takes up
+ to 10MHz), so spi_speed_hz is not used here.
+*/
+void nrf24_hal_begin(uint8_t ce_pin, uint8_t csn_pin, uint32_t spi_speed_hz) {
+    _ce_pin = ce_pin;
+    _csn_pin = csn_pin;
+    pinMode_d(_ce_pin, 1);
+    pinMode_d(_csn_pin, 1);
+    digitalWrite_d(_ce_pin, 0);
+    digitalWrite_d(_csn_pin, 1);
+    nrf24_init_hwspi();
+}
+
+void nrf24_hal_ce(uint8_t level) {
+    digitalWrite_d(_ce_pin, level);
+}
+
+void nrf24_hal_xfer(Nrf24Xfer *x, uint8_t n) {
+    for (; n; n--, x++) {
+        digitalWrite_d(_csn_pin, 0);
+        _delay_us(1);
+        uint8_t *p = x->buf;
+        for (uint8_t i = 0; i < x->len; i++, p++) *p = spi_transfer(*p);
+        digitalWrite_d(_csn_pin, 1);
+        _delay_us(1);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef NRF24_HAL_H
+#define NRF24_HAL_H
+
+#include <stdint.h>
+
+/*
+ What nrf24.c needs from the board. The AVR side is nrf24_avr.c; on a PC the
+ same nrf24.c links against tools/nrf24_host.c (spidev or the mock).
+*/
+
+// One CSN-framed SPI transaction; buf is sent and overwritten with what came back
+typedef struct {
+    uint8_t *buf;
+    uint8_t len;
+} Nrf24Xfer;
+
+void nrf24_hal_begin(uint8_t ce_pin, uint8_t csn_pin, uint32_t spi_speed_hz);
+void nrf24_hal_ce(uint8_t level);
+// n transactions back to back (CSN high between them); on Linux a single ioctl
+void nrf24_hal_xfer(Nrf24Xfer *x, uint8_t n);
+
+#ifdef __AVR__
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+#include <util/delay.h>
+#define nrf24_hal_delay_us(us) _delay_us(us)
+#else
+void nrf24_hal_delay_us(uint32_t us);
+#endif
+
+#endif
@@ -0,0 +1,31 @@
+#include "telem.h"
+#include "uart.h"
+
+uint16_t telem_dropped = 0;
+
+/**
+ * @brief Monta o registro e enfileira na serial.
+ * @return 1 se foi enfileirado; 0 se a fila estava cheia (descartado).
+ *
+ * Custo limitado pelo tamanho do registro (até TELEM_MAX_RECORD bytes
+ * copiados duas vezes), sem esperar a serial; só o laço principal chama.
+ */
+uint8_t telem_send(uint8_t type, uint16_t ts, const void *payload, uint8_t len) {
+  uint8_t rec[TELEM_MAX_RECORD];
+  const uint8_t *p = payload;
+  if (len > TELEM_MAX_PAYLOAD) len = TELEM_MAX_PAYLOAD;
+
+  rec[0] = TELEM_SYNC;
+  rec[1] = type;
+  rec[2] = len;
+  rec[3] = (uint8_t)ts;
+  rec[4] = ts >> 8;
+  for (uint8_t i = 0; i < len; i++) rec[TELEM_HEADER + i] = p[i];
+  rec[TELEM_HEADER + len] = telem_checksum(rec, len);
+
+  if (!uart_write(rec, TELEM_HEADER + len + 1)) {
+    telem_dropped++;
+    return 0;
+  }
+  return 1;
+}
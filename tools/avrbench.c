@@ -0,0 +1,494 @@
+/**
+ * @file avrbench.c
+ * @brief Benchmark dos firmwares no simulador de ATmega328P (simavr), sem hardware.
+ *
+ * Roda o ELF do carrinho ou do controle (compilados com BENCH_MARKS pelo
+ * make bench) por alguns segundos simulados, com o nRF24L01+ do nrf24_mock.c
+ * na SPI (TX_DS 300us depois de cada pulso do CE), os botões
+ * soltos e tensões no ADC:
+ *  - carrinho: um quadro do controle a cada HOP_PERIOD_MS e o LDR com luz
+ *    ambiente e, no meio, o código de outro jogador na mira;
+ *  - controle: o manche passeando nos dois eixos.
+ *
+ * Mede, em ciclos exatos da CPU:
+ *  - cada função do ELF: ciclos próprios por chamada (sem as funções que ela
+ *    chama; funções que o compilador embutiu não aparecem) e % da CPU;
+ *  - os trechos entre pontos do rastro (trace.h), que com BENCH_MARKS viram
+ *    escritas em GPIOR0: trabalho do laço, quadro lido até os motores, envio
+ *    etc., com média e máximo;
+ *  - flash (.text + .data), SRAM estática (.data + .bss) e o pico da pilha.
+ *
+ * A SPI segue o tempo de transferência do modelo do simavr, não o SCK real:
+ * os ciclos das funções do nrf24_avr.c servem para comparar versões, não
+ * para prever o tempo exato na placa.
+ *
+ * A simulação é determinística: o mesmo ELF dá sempre os mesmos números, e
+ * qualquer aumento contra a referência (-b) é uma mudança real no código.
+ *
+ * Uso: avrbench [-s segundos] [-o resultado.txt] [-b referência.txt] [-t tolerância_%] firmware.elf...
+ *   -o  grava as métricas (uma "chave valor" por linha) para virar a referência
+ *   -b  compara com a referência e sai com erro se alguma piorou ou se a
+ *       referência falta
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <libgen.h>
+#include <gelf.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_io.h>
+#include <simavr/sim_time.h>
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_spi.h>
+#include <simavr/avr_adc.h>
+#include "nRF24L01.h"
+#include "nrf24_mock.h"
+#include "radiocfg.h"
+#include "frame.h"
+#include "hop.h"
+#include "laser.h"
+#include "trace.h"
+
+#define F_SIM      16000000
+#define RAMEND     0x8FF
+#define SRAM_SIZE  2048
+#define GPIOR0_ADDR 0x3E   // GPIOR0 no espaço de dados (I/O 0x1E)
+#define SPL_ADDR   0x5D
+#define SPH_ADDR   0x5E
+#define CE_PIN     1       // PB1 (pino 9 do Arduino)
+#define CSN_PIN    2       // PB2 (pino 10)
+#define MAX_METRICS 512
+
+/*** Métricas ***/
+
+typedef struct {
+  char name[64];
+  double value;
+} Metric;
+
+static Metric metrics[MAX_METRICS];
+static int nmetrics;
+
+static void metric(const char *fw, const char *key, double value) {
+  if (nmetrics == MAX_METRICS) return;
+  snprintf(metrics[nmetrics].name, sizeof(metrics[0].name), "%s.%s", fw, key);
+  metrics[nmetrics++].value = value;
+}
+
+/*** Símbolos e seções do ELF ***/
+
+typedef struct {
+  uint32_t addr, end;
+  char     name[40];
+  long     calls;
+  uint64_t cycles;
+} Func;
+
+typedef struct {
+  Func    *func;
+  int      nfunc;
+  uint32_t flash, sram;
+  int      car; // tem ldr_sample(): é o carrinho
+} Image;
+
+static int by_addr(const void *a, const void *b) {
+  const Func *x = a, *y = b;
+  return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+static int load_image(const char *path, Image *img) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    perror(path);
+    return 0;
+  }
+  elf_version(EV_CURRENT);
+  Elf *e = elf_begin(fd, ELF_C_READ, NULL);
+  size_t shstrndx;
+  if (!e || elf_getshdrstrndx(e, &shstrndx)) {
+    fprintf(stderr, "%s: ELF inválido\n", path);
+    close(fd);
+    return 0;
+  }
+
+  memset(img, 0, sizeof(*img));
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn(e, scn))) {
+    GElf_Shdr sh;
+    gelf_getshdr(scn, &sh);
+    const char *sec = elf_strptr(e, shstrndx, sh.sh_name);
+    if (!strcmp(sec, ".text") || !strcmp(sec, ".data")) img->flash += sh.sh_size;
+    if (!strcmp(sec, ".data") || !strcmp(sec, ".bss") || !strcmp(sec, ".noinit")) img->sram += sh.sh_size;
+    if (sh.sh_type != SHT_SYMTAB) continue;
+
+    Elf_Data *d = elf_getdata(scn, NULL);
+    size_t n = sh.sh_size / sh.sh_entsize;
+    img->func = calloc(n, sizeof(Func));
+    for (size_t i = 0; i < n; i++) {
+      GElf_Sym sym;
+      gelf_getsym(d, i, &sym);
+      if (GELF_ST_TYPE(sym.st_info) != STT_FUNC || !sym.st_size) continue;
+      Func *f = &img->func[img->nfunc++];
+      f->addr = sym.st_value;
+      f->end = sym.st_value + sym.st_size;
+      snprintf(f->name, sizeof(f->name), "%s", elf_strptr(e, sh.sh_link, sym.st_name));
+      if (!strcmp(f->name, "ldr_sample")) img->car = 1;
+    }
+  }
+  elf_end(e);
+  close(fd);
+  qsort(img->func, img->nfunc, sizeof(Func), by_addr);
+  return 1;
+}
+
+static Func *func_at(Image *img, uint32_t pc) {
+  int lo = 0, hi = img->nfunc - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    Func *f = &img->func[mid];
+    if (pc < f->addr) hi = mid - 1;
+    else if (pc >= f->end) lo = mid + 1;
+    else return f;
+  }
+  return NULL;
+}
+
+/*** Simulação ***/
+
+typedef struct {
+  avr_t   *avr;
+  Image   *img;
+  Nrf24Mock nrf;
+  uint32_t rng;
+  uint64_t sleep;      // ciclos com a CPU dormindo
+  uint16_t sp_min;
+  // Estímulos
+  uint8_t  seq;
+} Sim;
+
+typedef struct {
+  uint8_t from, to;
+  const char *key;
+  const char *what;
+  long     n;
+  uint64_t sum, max;
+  uint8_t  pending;
+  uint64_t at;
+} Span;
+
+static Span spans[] = {
+  {TR_LOOP,     TR_LOOP_END, "laco",       "trabalho do laço"},
+  {TR_LOOP,     TR_RX,       "laco_rx",    "laço -> quadro lido"},
+  {TR_RX,       TR_MOTOR,    "rx_motores", "quadro lido -> motores"},
+  {TR_ADC,      TR_HIT,      "adc_tiro",   "ADC -> tiro tratado"},
+  {TR_LOOP,     TR_TX_START, "laco_envio", "laço -> início do envio"},
+  {TR_TX_START, TR_TX_DONE,  "envio",      "envio (txbox)"},
+};
+#define SPANS (sizeof(spans) / sizeof(spans[0]))
+
+static uint32_t lcg(Sim *s) {
+  s->rng = s->rng * 1664525u + 1013904223u;
+  return s->rng >> 8;
+}
+
+static void mark_write(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param) {
+  avr->data[addr] = v;
+  for (unsigned k = 0; k < SPANS; k++) {
+    Span *p = &spans[k];
+    if (v == p->to && p->pending) {
+      uint64_t d = avr->cycle - p->at;
+      p->n++;
+      p->sum += d;
+      if (d > p->max) p->max = d;
+      p->pending = 0;
+    }
+    if (v == p->from) {
+      p->pending = 1;
+      p->at = avr->cycle;
+    }
+  }
+}
+
+static void spi_out(struct avr_irq_t *irq, uint32_t value, void *param) {
+  Sim *s = param;
+  avr_raise_irq(avr_io_getirq(s->avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_INPUT), nrf24_mock_byte(&s->nrf, value));
+}
+
+static void csn_pin(struct avr_irq_t *irq, uint32_t value, void *param) {
+  Sim *s = param;
+  if (value) nrf24_mock_deselect(&s->nrf);
+}
+
+// O relógio do modelo só anda aqui: cada envio leva airtime_us (PLL, ar e ACK)
+static avr_cycle_count_t tx_done(avr_t *avr, avr_cycle_count_t when, void *param) {
+  Sim *s = param;
+  nrf24_mock_advance(&s->nrf, s->nrf.airtime_us);
+  if (s->nrf.tx_end) avr_cycle_timer_register_usec(s->avr, s->nrf.airtime_us, tx_done, s);
+  return 0;
+}
+
+static void ce_pin(struct avr_irq_t *irq, uint32_t value, void *param) {
+  Sim *s = param;
+  int busy = s->nrf.tx_end != 0;
+  nrf24_mock_ce(&s->nrf, value);
+  if (!busy && s->nrf.tx_end) avr_cycle_timer_register_usec(s->avr, s->nrf.airtime_us, tx_done, s);
+}
+
+/**
+ * @brief Carrinho: um quadro do controle por HOP_PERIOD_MS, manche em círculo.
+ */
+static avr_cycle_count_t car_frame(avr_t *avr, avr_cycle_count_t when, void *param) {
+  Sim *s = param;
+  double t = (double)when / F_SIM;
+  Controls c = {(int8_t)(100 * sin(t * 3)), (int8_t)(100 * cos(t * 3)), 0, 0};
+  static const uint8_t addr[5] = RADIO_ADDRESS;
+  Frame f;
+  frame_encode(&f, &c, s->seq++, (uint16_t)(t * 1000));
+  nrf24_mock_inject(&s->nrf, addr, &f, sizeof(f));
+  return when + avr_usec_to_cycles(avr, HOP_PERIOD_MS * 1000);
+}
+
+/**
+ * @brief Carrinho: LDR com luz ambiente e ruído e, entre 0,5s e 1,5s, o
+ * código do jogador 1 na mira (chips de LASER_CHIP_MS).
+ */
+static avr_cycle_count_t car_ldr(avr_t *avr, avr_cycle_count_t when, void *param) {
+  static const uint16_t codes[LASER_PLAYERS] = LASER_CODES;
+  Sim *s = param;
+  double ms = (double)when * 1000 / F_SIM;
+  uint32_t mv = 2300 + lcg(s) % 40;
+  if (ms >= 500 && ms < 1500) {
+    unsigned chip = (unsigned)(ms / LASER_CHIP_MS) % LASER_CODE_BITS;
+    if (codes[1] >> (LASER_CODE_BITS - 1 - chip) & 1) mv += 800;
+  }
+  avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0), mv);
+  return when + avr_usec_to_cycles(avr, 100);
+}
+
+/**
+ * @brief Controle: manche passeando nos dois eixos (JY no ADC0, JX no ADC1).
+ */
+static avr_cycle_count_t ctl_stick(avr_t *avr, avr_cycle_count_t when, void *param) {
+  double t = (double)when / F_SIM;
+  avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0), 2500 + 1500 * sin(t * 2));
+  avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC1), 2500 + 1500 * cos(t * 5));
+  return when + avr_usec_to_cycles(avr, 1000);
+}
+
+static void pin_high(avr_t *avr, char port, int pin) {
+  avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), pin), 1);
+}
+
+/**
+ * @brief Roda o firmware por seconds simulados, instrução por instrução.
+ * @return 0 se a CPU travou ou parou antes.
+ */
+static int run(Sim *s, double seconds) {
+  avr_t *avr = s->avr;
+  avr_cycle_count_t until = seconds * F_SIM;
+
+  while (avr->cycle < until) {
+    uint32_t pc = avr->pc;
+    avr_cycle_count_t c0 = avr->cycle;
+    int sleeping = avr->state == cpu_Sleeping;
+
+    int state = avr_run(avr);
+    if (state == cpu_Done || state == cpu_Crashed) {
+      fprintf(stderr, "a CPU parou em %.3fs (pc 0x%04x)\n", (double)avr->cycle / F_SIM, avr->pc);
+      return 0;
+    }
+
+    uint64_t dc = avr->cycle - c0;
+    if (sleeping) {
+      s->sleep += dc;
+    } else {
+      Func *f = func_at(s->img, pc);
+      if (f) f->cycles += dc;
+      Func *g = avr->pc != pc ? func_at(s->img, avr->pc) : NULL;
+      if (g && g != f && avr->pc == g->addr) g->calls++;
+    }
+
+    uint16_t sp = avr->data[SPL_ADDR] | avr->data[SPH_ADDR] << 8;
+    if (sp < s->sp_min) s->sp_min = sp;
+  }
+  return 1;
+}
+
+static int by_cycles(const void *a, const void *b) {
+  const Func *x = a, *y = b;
+  return x->cycles < y->cycles ? 1 : x->cycles > y->cycles ? -1 : 0;
+}
+
+/**
+ * @brief Simula um ELF e acumula as métricas com o nome do arquivo como prefixo.
+ */
+static int bench(const char *path, double seconds) {
+  Image img;
+  if (!load_image(path, &img)) return 0;
+
+  elf_firmware_t fw = {{0}};
+  if (elf_read_firmware(path, &fw)) {
+    fprintf(stderr, "%s: o simavr não leu o ELF\n", path);
+    return 0;
+  }
+  strcpy(fw.mmcu, "atmega328p");
+  fw.frequency = F_SIM;
+  fw.vcc = fw.avcc = fw.aref = 5000;
+
+  Sim s = {.img = &img, .rng = 1, .sp_min = RAMEND};
+  s.avr = avr_make_mcu_by_name(fw.mmcu);
+  avr_init(s.avr);
+  avr_load_firmware(s.avr, &fw);
+  nrf24_mock_reset(&s.nrf);
+  for (unsigned k = 0; k < SPANS; k++) spans[k].n = spans[k].sum = spans[k].max = spans[k].pending = 0;
+
+  avr_register_io_write(s.avr, GPIOR0_ADDR, mark_write, &s);
+  avr_irq_register_notify(avr_io_getirq(s.avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_OUTPUT), spi_out, &s);
+  avr_irq_register_notify(avr_io_getirq(s.avr, AVR_IOCTL_IOPORT_GETIRQ('B'), CSN_PIN), csn_pin, &s);
+  avr_irq_register_notify(avr_io_getirq(s.avr, AVR_IOCTL_IOPORT_GETIRQ('B'), CE_PIN), ce_pin, &s);
+
+  if (img.car) {
+    pin_high(s.avr, 'D', 7);  // botão de debug solto
+    avr_cycle_timer_register_usec(s.avr, 100, car_ldr, &s);
+    avr_cycle_timer_register_usec(s.avr, 50000, car_frame, &s);
+  } else {
+    pin_high(s.avr, 'C', 2);  // JS e TRIGGER soltos
+    pin_high(s.avr, 'C', 3);
+    avr_cycle_timer_register_usec(s.avr, 1, ctl_stick, &s);
+  }
+
+  char name[64], copy[256];
+  snprintf(copy, sizeof(copy), "%s", path);
+  snprintf(name, sizeof(name), "%s", basename(copy));
+  char *dot = strrchr(name, '.');
+  if (dot) *dot = 0;
+
+  if (!run(&s, seconds)) return 0;
+
+  uint64_t total = s.avr->cycle, busy = total - s.sleep;
+  uint32_t stack = RAMEND - s.sp_min;
+  printf("# %s: %.1fs simulados, CPU ativa %.1f%%", name, seconds, 100.0 * busy / total);
+  if (img.car) printf(", %ld quadros recebidos, %ld perdidos na FIFO\n", s.nrf.received, s.nrf.overflow);
+  else printf(", %ld envios\n", s.nrf.sent);
+  printf("flash %u bytes, SRAM estática %u bytes, pico da pilha %u bytes (sobram %d)\n",
+         img.flash, img.sram, stack, SRAM_SIZE - (int)img.sram - (int)stack);
+  metric(name, "flash", img.flash);
+  metric(name, "sram", img.sram);
+  metric(name, "pilha", stack);
+
+  printf("trecho                      n    média   máx (ciclos)\n");
+  for (unsigned k = 0; k < SPANS; k++) {
+    Span *p = &spans[k];
+    if (!p->n) continue;
+    double avg = (double)p->sum / p->n;
+    printf("%-24s %5ld %8.1f %6llu\n", p->what, p->n, avg, (unsigned long long)p->max);
+    char key[48];
+    snprintf(key, sizeof(key), "%s.media", p->key);
+    metric(name, key, avg);
+    snprintf(key, sizeof(key), "%s.max", p->key);
+    metric(name, key, p->max);
+  }
+
+  qsort(img.func, img.nfunc, sizeof(Func), by_cycles);
+  printf("função                    chamadas  ciclos/chamada  %% da CPU ativa\n");
+  for (int i = 0; i < img.nfunc; i++) {
+    Func *f = &img.func[i];
+    if (!f->calls) continue;
+    double per = (double)f->cycles / f->calls;
+    printf("%-26s %8ld %14.1f %8.2f\n", f->name, f->calls, per, 100.0 * f->cycles / busy);
+    char key[48];
+    snprintf(key, sizeof(key), "f.%s", f->name);
+    metric(name, key, per);
+  }
+  free(img.func);
+  return 1;
+}
+
+/*** Referência ***/
+
+static int save(const char *path) {
+  FILE *out = fopen(path, "w");
+  if (!out) {
+    perror(path);
+    return 0;
+  }
+  for (int i = 0; i < nmetrics; i++) fprintf(out, "%s %.1f\n", metrics[i].name, metrics[i].value);
+  return fclose(out) == 0;
+}
+
+/**
+ * @brief Compara com a referência; piorou é subir mais que a tolerância e
+ * mais de 2 (ciclos ou bytes), para arredondamentos não contarem.
+ * @return métricas que pioraram, ou -1 sem referência (arquivo que falta, não
+ *         abre ou não tem nenhuma métrica desta execução): também é falha.
+ */
+static int compare(const char *path, double tol) {
+  FILE *in = fopen(path, "r");
+  if (!in) {
+    perror(path);
+    printf("# sem referência: make bench grava a primeira (faça o commit dela)\n");
+    return -1;
+  }
+
+  int worse = 0, better = 0, matched = 0;
+  char name[64];
+  double base;
+  printf("# comparado com %s (tolerância %.1f%%)\n", path, tol * 100);
+  while (fscanf(in, "%63s %lf", name, &base) == 2) {
+    for (int i = 0; i < nmetrics; i++) {
+      if (strcmp(metrics[i].name, name)) continue;
+      double now = metrics[i].value, d = now - base;
+      matched++;
+      if (d > 2 && d > tol * base) {
+        printf("PIOROU  %-40s %10.1f -> %10.1f (%+.1f%%)\n", name, base, now, base ? 100 * d / base : 100);
+        worse++;
+      } else if (-d > 2 && -d > tol * base) {
+        printf("melhor  %-40s %10.1f -> %10.1f (%+.1f%%)\n", name, base, now, 100 * d / base);
+        better++;
+      }
+      break;
+    }
+  }
+  fclose(in);
+  if (!matched) {
+    printf("# %s não tem nenhuma das métricas desta execução\n", path);
+    return -1;
+  }
+  printf("# %d métricas comparadas: %d pioraram, %d melhoraram\n", matched, worse, better);
+  return worse;
+}
+
+int main(int argc, char **argv) {
+  double seconds = 2, tol = 0.01;
+  const char *out = NULL, *base = NULL;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "s:o:b:t:")) != -1) {
+    switch (opt) {
+    case 's': seconds = atof(optarg); break;
+    case 'o': out = optarg; break;
+    case 'b': base = optarg; break;
+    case 't': tol = atof(optarg) / 100; break;
+    default:
+      goto usage;
+    }
+  }
+  if (optind == argc) goto usage;
+
+  for (int i = optind; i < argc; i++) {
+    if (!bench(argv[i], seconds)) return 1;
+    printf("\n");
+  }
+  if (out && !save(out)) return 1;
+  if (base && compare(base, tol) != 0) return 1;
+  return 0;
+
+usage:
+  fprintf(stderr, "uso: %s [-s segundos] [-o resultado.txt] [-b referência.txt] [-t tolerância_%%] firmware.elf...\n", argv[0]);
+  return 1;
+}
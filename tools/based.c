@@ -0,0 +1,284 @@
+/**
+ * @file based.c
+ * @brief Recebe a telemetria da estação base (base/) e grava a partida.
+ *
+ * Lê os registros TELEM_CAR da serial da base (-d, crua em UART_BAUD), de
+ * uma captura ou da entrada padrão e acrescenta ao registro da partida
+ * (matchlog.h, -o partida.log):
+ *  - MATCH_REPORT para cada relatório, com o gap de seq desde o anterior do
+ *    mesmo carrinho (relatórios perdidos no ar ou na FIFO da base);
+ *  - MATCH_HIT para cada tiro novo, com quem atirou: a diferença entre os
+ *    contadores do relatório e os do anterior, então um relatório perdido
+ *    não perde tiros, só os atrasa;
+ *  - MATCH_BOOT quando o carrinho reinicia: o primeiro relatório com
+ *    REPORT_BOOT (o carrinho marca os REPORT_BOOT_SEQS primeiros, então o
+ *    boot não se perde com um relatório) ou com seq para trás dentro deles.
+ *    Os contadores do carrinho recomeçam e a partida continua somando.
+ *
+ * O hits_by de cada evento é o acumulado da partida, então o placar sai do
+ * último evento de cada carrinho (matchq). Reabrir um registro continua a
+ * partida: os totais voltam do último evento e os contadores do primeiro
+ * relatório de cada carrinho viram a referência.
+ *
+ * O tempo dos eventos é a hora do PC no primeiro registro mais o relógio da
+ * base desenrolado (16 bits em ms, a base manda TELEM_BASE a cada segundo),
+ * então uma captura regravada mantém os intervalos de quando foi feita.
+ *
+ * -s N não precisa da base: gera N relatórios de seis carrinhos (perdas,
+ * tiros e um reboot no meio), codificados como a base envia, e passa pelo
+ * mesmo caminho; serve para medir a vazão do registro.
+ *
+ * Uso: based -o partida.log [-d tty] [-b baud] [-i segundos] [-s N] [arquivo]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
+#include "telemrx.h"
+#include "matchlog.h"
+#include "uart.h"
+
+typedef struct {
+  int      seen;
+  int      boot;                      // o último relatório tinha REPORT_BOOT
+  uint8_t  seq;
+  uint8_t  raw[REPORT_SHOOTERS];      // contadores do último relatório
+  uint16_t hits_by[REPORT_SHOOTERS];  // acumulado da partida
+  long     reports, gaps, boots, mismatched;
+} Car;
+
+static Car cars[MATCHLOG_CARS];
+static MatchLog log_;
+static TelemBase base;
+static long appended, base_reports;
+
+static uint64_t now_us(int clock) {
+  struct timespec t;
+  clock_gettime(clock, &t);
+  return t.tv_sec * 1000000ull + t.tv_nsec / 1000;
+}
+
+/**
+ * @brief Totais da partida até aqui, do último evento de cada carrinho.
+ */
+static void resume(void) {
+  for (int c = 0; c < MATCHLOG_CARS; c++) {
+    const MatchEvent *e = matchlog_car_last(&log_, c);
+    if (e) memcpy(cars[c].hits_by, e->hits_by, sizeof(e->hits_by));
+  }
+}
+
+static void append(MatchEvent *e, const Car *car) {
+  memcpy(e->hits_by, car->hits_by, sizeof(e->hits_by));
+  if (matchlog_append(&log_, e) < 0) exit(1);
+  appended++;
+}
+
+static void car_report(uint64_t t, const TelemCar *tc) {
+  const CarReport *r = &tc->report;
+  if (tc->pipe >= MATCHLOG_CARS) return;
+  Car *car = &cars[tc->pipe];
+  MatchEvent e = {
+    .t_us = t, .car_ms = r->ms, .accepted = r->accepted, .lost = r->lost, .car = tc->pipe,
+    .seq = r->seq, .life = r->life, .flags = r->flags, .latency = r->latency,
+  };
+
+  int boot = r->flags & REPORT_BOOT;
+  int rebooted = boot && (!car->seen || !car->boot || r->seq < car->seq);
+
+  car->reports++;
+  if (r->player != tc->pipe) car->mismatched++;
+  if (rebooted) e.gap = car->seen ? r->seq : 0;
+  else if (car->seen) e.gap = r->seq - car->seq - 1;
+  car->gaps += e.gap;
+  car->seq = r->seq;
+  car->boot = boot;
+
+  if (rebooted) {
+    // Os contadores do boot começam do zero, não do último relatório
+    memset(car->raw, 0, sizeof(car->raw));
+    car->boots++;
+    e.kind = MATCH_BOOT;
+    append(&e, car);
+  } else if (!car->seen) {
+    // Começou no meio: o que já estava contado não é desta gravação
+    memcpy(car->raw, r->hits_by, sizeof(car->raw));
+  }
+  car->seen = 1;
+
+  for (int s = 0; s < REPORT_SHOOTERS; s++) {
+    for (uint8_t d = r->hits_by[s] - car->raw[s]; d; d--) {
+      car->hits_by[s]++;
+      e.kind = MATCH_HIT;
+      e.shooter = s;
+      append(&e, car);
+    }
+    car->raw[s] = r->hits_by[s];
+  }
+  e.kind = MATCH_REPORT;
+  e.shooter = 0;
+  append(&e, car);
+}
+
+static void status(FILE *f, const TelemRx *rx, double secs) {
+  fprintf(f, "# %ld registros (%ld ruins), %ld eventos em %.1fs (%.0f/s), %llu no registro\n", rx->records,
+          rx->bad, appended, secs, secs > 0 ? appended / secs : 0, (unsigned long long)matchlog_count(&log_));
+  if (base_reports)
+    fprintf(f, "# base: %u leituras com a FIFO cheia, %u registros descartados na serial\n", base.full,
+            base.dropped);
+  fprintf(f, "# carro relatórios perdidos boots  acertos (de 0..%d)\n", REPORT_SHOOTERS - 1);
+  for (int c = 0; c < MATCHLOG_CARS; c++) {
+    const Car *car = &cars[c];
+    if (!car->reports) continue;
+    fprintf(f, "# %5d %10ld %8ld %5ld ", c, car->reports, car->gaps, car->boots);
+    for (int s = 0; s < REPORT_SHOOTERS; s++) fprintf(f, " %5u", car->hits_by[s]);
+    fprintf(f, car->mismatched ? "  (%ld com LASER_PLAYER errado)\n" : "\n", car->mismatched);
+  }
+}
+
+/*** Base de mentira para o -s ***/
+
+static uint32_t rng = 1;
+static uint32_t rand32(void) {
+  rng = rng * 1664525u + 1013904223u;
+  return rng >> 8;
+}
+
+static size_t put_record(uint8_t *out, uint8_t type, uint16_t ts, const void *payload, uint8_t len) {
+  out[0] = TELEM_SYNC;
+  out[1] = type;
+  out[2] = len;
+  out[3] = (uint8_t)ts;
+  out[4] = ts >> 8;
+  memcpy(out + TELEM_HEADER, payload, len);
+  out[TELEM_HEADER + len] = telem_checksum(out, len);
+  return TELEM_HEADER + len + 1;
+}
+
+/**
+ * @brief Seis carrinhos a cada REPORT_MS, defasados, com ~2% de perda e um
+ * tiro de vez em quando; o carrinho 3 reinicia na metade.
+ */
+static size_t synth(uint8_t *out, size_t cap, long *left) {
+  static CarReport r[MATCHLOG_CARS];
+  static uint8_t boot[MATCHLOG_CARS];
+  static uint32_t ms;
+  static long sent, reboot_at = -1;
+  size_t n = 0;
+
+  if (reboot_at < 0) reboot_at = *left / 2;
+  while (*left > 0 && n + 2 * TELEM_MAX_RECORD <= cap) {
+    ms += REPORT_MS / MATCHLOG_CARS;
+    int c = ms / (REPORT_MS / MATCHLOG_CARS) % MATCHLOG_CARS;
+
+    if (sent < MATCHLOG_CARS || (c == 3 && reboot_at && sent >= reboot_at)) {
+      memset(&r[c], 0, sizeof(r[c]));
+      boot[c] = 1;
+      if (sent >= MATCHLOG_CARS) reboot_at = 0;
+    }
+    if (r[c].seq == REPORT_BOOT_SEQS) boot[c] = 0;
+    r[c].flags = boot[c] ? REPORT_BOOT : 0;
+    r[c].player = c;
+    r[c].ms = ms;
+    r[c].accepted += REPORT_MS / 20;
+    r[c].life = 3;
+    if (rand32() % 16 == 0) r[c].hits_by[rand32() % REPORT_SHOOTERS]++;
+    TelemCar tc = {.pipe = c, .fifo = 1, .report = r[c]};
+    r[c].seq++;
+    sent++;
+    --*left;
+    if (rand32() % 50) n += put_record(out + n, TELEM_CAR, ms, &tc, sizeof(tc));
+    if (ms % 1000 < REPORT_MS / MATCHLOG_CARS) n += put_record(out + n, TELEM_BASE, ms, &base, sizeof(base));
+  }
+  return n;
+}
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+  stop = 1;
+}
+
+int main(int argc, char **argv) {
+  const char *tty = NULL, *path = NULL;
+  int interval = 0, baud = UART_BAUD, usage = 0, opt;
+  long synthetic = 0;
+
+  while ((opt = getopt(argc, argv, "o:d:b:i:s:")) != -1) {
+    switch (opt) {
+    case 'o': path = optarg; break;
+    case 'd': tty = optarg; break;
+    case 'b': baud = atoi(optarg); break;
+    case 'i': interval = atoi(optarg); break;
+    case 's': synthetic = atol(optarg); break;
+    default: usage = 1; break;
+    }
+  }
+  if (usage || !path) {
+    fprintf(stderr, "uso: %s -o partida.log [-d tty] [-b baud] [-i segundos] [-s N] [arquivo]\n", argv[0]);
+    return 1;
+  }
+
+  int fd = 0;
+  if (tty) fd = telemrx_open_tty(tty, baud);
+  else if (!synthetic && optind < argc && (fd = open(argv[optind], O_RDONLY)) < 0) {
+    perror(argv[optind]);
+    return 1;
+  }
+  if (matchlog_open(&log_, path, 1) < 0) return 1;
+  resume();
+
+  struct sigaction sa = {.sa_handler = on_signal};
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  TelemRx rx = {0};
+  uint64_t anchor_us = 0, t_ms = 0;
+  uint16_t last_ts = 0;
+  int started = 0;
+  uint64_t t0 = now_us(CLOCK_MONOTONIC), last_status = t0;
+  static uint8_t buf[1 << 16];
+  ssize_t n;
+
+  while (!stop && (n = synthetic ? (ssize_t)synth(buf, sizeof(buf), &synthetic) : read(fd, buf, sizeof(buf))) > 0) {
+    for (ssize_t i = 0; i < n; i++) {
+      if (!telemrx_push(&rx, buf[i])) continue;
+      uint8_t type = telemrx_type(&rx), len = telemrx_len(&rx);
+      uint16_t ts = telemrx_ts(&rx);
+      const uint8_t *p = telemrx_payload(&rx);
+
+      if (!started) {
+        started = 1;
+        last_ts = ts;
+        // Depois do último evento gravado, mesmo com o relógio do PC para trás
+        anchor_us = now_us(CLOCK_REALTIME);
+        uint64_t count = matchlog_count(&log_);
+        if (count && log_.ev[count - 1].t_us > anchor_us) anchor_us = log_.ev[count - 1].t_us;
+      }
+      t_ms += (uint16_t)(ts - last_ts);
+      last_ts = ts;
+
+      if (type == TELEM_CAR && len == sizeof(TelemCar)) {
+        TelemCar tc;
+        memcpy(&tc, p, sizeof(tc));
+        car_report(anchor_us + t_ms * 1000, &tc);
+      } else if (type == TELEM_BASE && len == sizeof(TelemBase)) {
+        memcpy(&base, p, sizeof(base));
+        base_reports++;
+      }
+    }
+    uint64_t now = now_us(CLOCK_MONOTONIC);
+    if (interval && now - last_status >= interval * 1000000ull) {
+      last_status = now;
+      status(stderr, &rx, (now - t0) / 1e6);
+    }
+  }
+
+  status(stdout, &rx, (now_us(CLOCK_MONOTONIC) - t0) / 1e6);
+  matchlog_close(&log_);
+  return 0;
+}
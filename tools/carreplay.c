@@ -0,0 +1,429 @@
+/**
+ * @file carreplay.c
+ * @brief Repete no PC uma captura do carrinho no próprio firmware (carrinho.c).
+ *
+ * Com CAPTURE_ENABLE o carrinho envia pela telemetria, a cada período, um
+ * TELEM_CAPTURE com as amostras do LDR daquele período e o estado no começo
+ * dele (PWM aplicado nos dois motores e vida), e um TELEM_FRAME com cada
+ * quadro lido do rádio. Aqui o carrinho.c inteiro roda compilado para o PC
+ * (hostavr/ no lugar da avr-libc e um rádio falso): setup() e, para cada
+ * período gravado, COMPA do Timer1, as amostras pelo ADC_vect, loop() com o
+ * quadro daquele período e o COMPB. Antes de cada período o estado do
+ * firmware é comparado com o gravado; qualquer diferença é uma regressão (ou
+ * uma mudança de comportamento de propósito, e aí -w grava a captura nova).
+ *
+ * A repetição só é exata no nível do período: o que mudou dentro dele (um
+ * quadro que chegou depois do laço, por exemplo) já entra no período seguinte
+ * da captura. Ela precisa do carrinho.c com a mesma configuração (CONTROL_HZ,
+ * LASER_PLAYER, HOP_ENABLE...) de quando foi gravada, e começa no boot: só o
+ * primeiro boot da captura é repetido.
+ *
+ * Com -g gera uma captura sintética: quadros do controle a cada -f ms com o
+ * manche passeando e perda aleatória, e o LDR de um traço do ldrreplay -g
+ * (-l) ou só luz ambiente. O estado esperado vem da própria repetição.
+ *
+ * Uso: carreplay [-w nova.bin] captura.bin
+ *      carreplay -g [-d segundos] [-p perda_%] [-f quadro_ms] [-l traço] [-s semente] saída.bin
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <avr/io.h>
+#include "telemrx.h"
+#include "nrf24_avr.h"
+#include "frame.h"
+#include "ldr.h"
+
+#define MAX_REPORT 10 // diferenças impressas uma a uma
+
+// Do carrinho.c
+typedef struct {
+  int16_t left;
+  int16_t right;
+} MotorCmd;
+
+extern volatile uint16_t ms_ticks;
+extern uint8_t life;
+extern MotorCmd output;
+void setup(void);
+void loop(void);
+void TIMER1_COMPA_vect(void);
+void TIMER1_COMPB_vect(void);
+void TIMER0_OVF_vect(void);
+void ADC_vect(void);
+
+/**
+ * @brief Um período do laço gravado.
+ */
+typedef struct {
+  uint16_t     ms;
+  TelemCapture head; // esperado no começo do período
+  uint8_t      sample[TELEM_CAPTURE_SAMPLES];
+  uint8_t      has_frame;
+  Frame        frame;
+} Period;
+
+static Period *periods;
+static long count, allocated;
+
+static Period *period_add(uint16_t ms) {
+  if (count == allocated) {
+    allocated = allocated ? 2 * allocated : 4096;
+    periods = realloc(periods, allocated * sizeof(Period));
+    if (!periods) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+  Period *p = &periods[count++];
+  memset(p, 0, sizeof(*p));
+  p->ms = ms;
+  return p;
+}
+
+/*** Rádio falso: entrega o quadro gravado no período ***/
+
+static const Frame *rx_frame;
+static uint8_t rx_channel;
+
+uint8_t nrf24_begin_config(uint8_t ce_pin, uint8_t csn_pin, uint32_t spi_speed_hz, const Nrf24Config *c) {
+  rx_channel = c->channel;
+  return 0;
+}
+void nrf24_startListening(void) {}
+void nrf24_setChannel(uint8_t channel) { rx_channel = channel; }
+uint8_t nrf24_getChannel(void) { return rx_channel; }
+uint8_t nrf24_available(void) { return rx_frame != NULL; }
+
+void nrf24_read(void *buf, uint8_t len) {
+  memcpy(buf, rx_frame, len < sizeof(Frame) ? len : sizeof(Frame));
+  rx_frame = NULL;
+}
+
+// REPORT_ENABLE: o relatório para a base sai na hora
+void nrf24_setTxAddress(const uint8_t *address) {}
+void nrf24_enableDynamicAck(void) {}
+void nrf24_startWrite(const void *buf, uint8_t len, uint8_t no_ack) {}
+uint8_t nrf24_txPoll(void) { return 1; }
+
+/*** Leitura e escrita das capturas ***/
+
+/**
+ * @brief Lê os períodos do primeiro boot da captura.
+ * @return 0 se não há nenhum período.
+ */
+static int load(FILE *in) {
+  TelemRx rx = {0};
+  long orphans = 0, resets = 0;
+  int c;
+
+  while ((c = fgetc(in)) != EOF) {
+    if (!telemrx_push(&rx, c)) continue;
+    uint8_t type = telemrx_type(&rx), len = telemrx_len(&rx);
+    const uint8_t *payload = telemrx_payload(&rx);
+
+    if (type == TELEM_RESET) {
+      if (resets++ && count) {
+        fprintf(stderr, "a captura tem outro boot depois de %ld períodos: só o primeiro é repetido\n", count);
+        break;
+      }
+    } else if (type == TELEM_CAPTURE && len >= sizeof(TelemCapture)) {
+      TelemCapture head;
+      memcpy(&head, payload, sizeof(head));
+      uint8_t n = head.samples == CAPTURE_OVERFLOW ? 0 : head.samples;
+      if (len != sizeof(head) + n) continue;
+      Period *p = period_add(telemrx_ts(&rx));
+      p->head = head;
+      memcpy(p->sample, payload + sizeof(head), n);
+    } else if (type == TELEM_FRAME && len == sizeof(Frame)) {
+      Period *p = count ? &periods[count - 1] : NULL;
+      if (p && p->ms == telemrx_ts(&rx) && !p->has_frame) {
+        memcpy(&p->frame, payload, sizeof(Frame));
+        p->has_frame = 1;
+      } else {
+        orphans++;
+      }
+    }
+  }
+
+  if (!resets) fprintf(stderr, "sem TELEM_RESET: a captura pode não começar no boot\n");
+  if (orphans) fprintf(stderr, "%ld quadros sem o período correspondente (registros perdidos)\n", orphans);
+  if (rx.bad) fprintf(stderr, "%ld registros descartados pela soma\n", rx.bad);
+  return count > 0;
+}
+
+static void put_record(FILE *out, uint8_t type, uint16_t ts, const void *payload, uint8_t len) {
+  uint8_t rec[TELEM_MAX_RECORD];
+  rec[0] = TELEM_SYNC;
+  rec[1] = type;
+  rec[2] = len;
+  rec[3] = (uint8_t)ts;
+  rec[4] = ts >> 8;
+  memcpy(rec + TELEM_HEADER, payload, len);
+  rec[TELEM_HEADER + len] = telem_checksum(rec, len);
+  fwrite(rec, 1, TELEM_HEADER + len + 1, out);
+}
+
+/**
+ * @brief Grava os períodos repetidos, no formato que o carrinho envia.
+ */
+static int save(const char *path, long n) {
+  FILE *out = fopen(path, "wb");
+  if (!out) {
+    perror(path);
+    return 0;
+  }
+
+  TelemReset reset = {0};
+  put_record(out, TELEM_RESET, 0, &reset, sizeof(reset));
+  for (long k = 0; k < n; k++) {
+    Period *p = &periods[k];
+    uint8_t buf[TELEM_MAX_PAYLOAD];
+    memcpy(buf, &p->head, sizeof(p->head));
+    memcpy(buf + sizeof(p->head), p->sample, p->head.samples);
+    put_record(out, TELEM_CAPTURE, p->ms, buf, sizeof(p->head) + p->head.samples);
+    if (p->has_frame) put_record(out, TELEM_FRAME, p->ms, &p->frame, sizeof(Frame));
+  }
+  return fclose(out) == 0;
+}
+
+/*** Captura sintética ***/
+
+static uint32_t rng = 1;
+static double frand(void) {
+  rng = rng * 1664525u + 1013904223u;
+  return (rng >> 8) / 16777216.0;
+}
+
+typedef struct {
+  double seconds;
+  double loss;     // probabilidade de perder cada quadro
+  int    frame_ms; // período de envio do controle
+  FILE  *ldr;      // traço do ldrreplay -g, ou NULL
+} Scene;
+
+/**
+ * @brief Próxima amostra do LDR: do traço ou luz ambiente com ruído.
+ * @return 0 no fim do traço.
+ */
+static int ldr_next(const Scene *sc, uint8_t *value) {
+  if (!sc->ldr) {
+    *value = 120 + (int)(5 * frand()) - 2;
+    return 1;
+  }
+  int v, player;
+  if (fscanf(sc->ldr, "%d %d", &v, &player) != 2) return 0;
+  *value = v < 0 ? 0 : v > 255 ? 255 : v;
+  return 1;
+}
+
+/**
+ * @brief Monta os períodos a partir do primeiro, em first_ms.
+ *
+ * O quadro enviado em t chega no período seguinte; cada período lê no
+ * máximo um quadro, como o receive().
+ */
+static void generate(const Scene *sc, uint16_t first_ms, int tick_ms) {
+  FrameTx tx;
+  Controls c = {0, 0, 1, 1};
+  double due = 0, vx = 0, vy = 0;
+  int pending = 0, trigger_ms = 0;
+  Frame frame;
+
+  frame_tx_begin(&tx, FRAME_REDUNDANCY);
+  for (long t = 0; t < sc->seconds * 1000; t += tick_ms) {
+    uint16_t ms = first_ms + t;
+    Period *p = period_add(ms);
+
+    due += (double)LDR_SAMPLE_HZ * tick_ms / 1000;
+    while (due >= 1 && p->head.samples < TELEM_CAPTURE_SAMPLES) {
+      if (!ldr_next(sc, &p->sample[p->head.samples])) {
+        count--;
+        return;
+      }
+      p->head.samples++;
+      due -= 1;
+    }
+
+    if (pending) {
+      p->frame = frame;
+      p->has_frame = 1;
+      pending = 0;
+    }
+
+    if (t % sc->frame_ms == 0) {
+      // Manche passeando devagar, com um toque no gatilho de vez em quando
+      vx = 0.95 * vx + 8 * (frand() - 0.5);
+      vy = 0.95 * vy + 8 * (frand() - 0.5);
+      c.x = vx < -127 ? -127 : vx > 127 ? 127 : vx;
+      c.y = vy < -127 ? -127 : vy > 127 ? 127 : vy;
+      if (trigger_ms > 0) trigger_ms -= sc->frame_ms;
+      else if (frand() < 0.01) trigger_ms = 200;
+      c.trigger = trigger_ms > 0 ? 0 : 1;
+
+      frame_tx_encode(&tx, &frame, &c, ms);
+      pending = frand() >= sc->loss;
+    }
+  }
+}
+
+/*** Repetição ***/
+
+typedef struct {
+  long periods;
+  long frames;
+  long samples;
+  long hits;      // mudanças de vida na captura
+  long replayed;  // mudanças de vida na repetição
+  long mismatches;
+  double ns;      // tempo de CPU da repetição
+} Result;
+
+static int same(const TelemCapture *a, const TelemCapture *b) {
+  return a->left == b->left && a->right == b->right && a->life == b->life;
+}
+
+/**
+ * @brief Roda o firmware pelos períodos gravados.
+ * @param bless 1 grava o estado repetido como esperado (-w), 2 também, mas
+ * sem listar as diferenças (-g, que ainda não tem o esperado).
+ */
+static Result replay(long n, int tick_ms, int bless) {
+  Result r = {0};
+  struct timespec t0, t1;
+  uint8_t last_expected = life, last_replayed = life;
+
+  ms_ticks = periods[0].ms - tick_ms;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (long k = 0; k < n; k++) {
+    Period *p = &periods[k];
+    TelemCapture now = {output.left, output.right, life, p->head.samples};
+
+    if (!same(&now, &p->head) && r.mismatches++ < MAX_REPORT && bless < 2) {
+      fprintf(stderr, "período %ld (%ums): esperado %d %d vida 0x%02x, repetido %d %d vida 0x%02x\n",
+              k, p->ms, p->head.left, p->head.right, p->head.life, now.left, now.right, now.life);
+    }
+    if (bless) p->head = now;
+    if (p->head.life != last_expected) r.hits++;
+    if (now.life != last_replayed) r.replayed++;
+    last_expected = p->head.life;
+    last_replayed = now.life;
+
+    TIMER1_COMPA_vect();
+    for (uint8_t i = 0; i < p->head.samples; i++) {
+      ADCH = p->sample[i];
+      ADC_vect();
+    }
+    r.samples += p->head.samples;
+    rx_frame = p->has_frame ? &p->frame : NULL;
+    r.frames += p->has_frame;
+    loop();
+    TIMER1_COMPB_vect();
+    if (TIMSK0 & ((1<<TOIE0) | (1<<OCIE0B))) TIMER0_OVF_vect();
+    r.periods++;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  r.ns = (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+  return r;
+}
+
+/**
+ * @brief Corta a captura no primeiro buraco: período perdido na serial ou
+ * amostras do LDR que não couberam no registro.
+ */
+static long usable(int tick_ms) {
+  for (long k = 0; k < count; k++) {
+    if (periods[k].head.samples == CAPTURE_OVERFLOW) {
+      fprintf(stderr, "período %ld (%ums): amostras do LDR perdidas, repetindo só até aqui\n", k, periods[k].ms);
+      return k;
+    }
+    if (k && periods[k].ms != (uint16_t)(periods[k - 1].ms + tick_ms)) {
+      fprintf(stderr, "período %ld (%ums): faltam registros antes dele, repetindo só até aqui\n", k, periods[k].ms);
+      return k;
+    }
+  }
+  return count;
+}
+
+int main(int argc, char **argv) {
+  Scene sc = {10, 0.05, 20, NULL};
+  const char *bless_path = NULL;
+  int gen = 0, opt;
+
+  while ((opt = getopt(argc, argv, "w:gd:p:f:l:s:")) != -1) {
+    switch (opt) {
+    case 'w': bless_path = optarg; break;
+    case 'g': gen = 1; break;
+    case 'd': sc.seconds = atof(optarg); break;
+    case 'p': sc.loss = atof(optarg) / 100; break;
+    case 'f': sc.frame_ms = atoi(optarg); break;
+    case 'l':
+      if (!(sc.ldr = fopen(optarg, "r"))) {
+        perror(optarg);
+        return 1;
+      }
+      break;
+    case 's': rng = atoi(optarg); break;
+    default:
+      goto usage;
+    }
+  }
+  if (optind != argc - 1 || sc.frame_ms <= 0) goto usage;
+
+  // Botão de debug solto (pull-up)
+  PIND = 0xFF;
+  setup();
+  int tick_ms = (OCR1A + 1) / (F_CPU / 8 / 1000);
+
+  if (gen) {
+    generate(&sc, ms_ticks + tick_ms, tick_ms);
+    if (!count) {
+      fprintf(stderr, "traço do LDR vazio\n");
+      return 1;
+    }
+    Result r = replay(count, tick_ms, 2);
+    if (!save(argv[optind], count)) return 1;
+    printf("%ld períodos, %ld quadros, %ld tiros gravados em %s\n", r.periods, r.frames, r.hits, argv[optind]);
+    return 0;
+  }
+
+  FILE *in = fopen(argv[optind], "rb");
+  if (!in) {
+    perror(argv[optind]);
+    return 1;
+  }
+  if (!load(in)) {
+    fprintf(stderr, "nenhum TELEM_CAPTURE em %s (carrinho sem CAPTURE_ENABLE?)\n", argv[optind]);
+    return 1;
+  }
+
+  long n = usable(tick_ms);
+  if (!n) return 1;
+  Result r = replay(n, tick_ms, bless_path != NULL);
+  printf("%ld períodos (%.1fs), %ld quadros, %ld amostras do LDR\n",
+         r.periods, r.periods * tick_ms / 1000.0, r.frames, r.samples);
+  printf("mudanças de vida: %ld na captura, %ld na repetição\n", r.hits, r.replayed);
+  printf("repetição: %.0fns por período (%.0fx o tempo real)\n",
+         r.ns / r.periods, r.periods * tick_ms * 1e6 / r.ns);
+
+  if (bless_path) {
+    if (!save(bless_path, n)) return 1;
+    printf("%ld diferenças aceitas, captura nova em %s\n", r.mismatches, bless_path);
+    return 0;
+  }
+  if (r.mismatches) {
+    printf("%ld períodos diferentes da captura\n", r.mismatches);
+    return 1;
+  }
+  printf("igual à captura\n");
+  return 0;
+
+usage:
+  fprintf(stderr, "uso: %s [-w nova.bin] captura.bin\n"
+                  "     %s -g [-d segundos] [-p perda_%%] [-f quadro_ms] [-l traço] [-s semente] saída.bin\n",
+          argv[0], argv[0]);
+  return 1;
+}
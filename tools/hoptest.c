@@ -0,0 +1,83 @@
+/**
+ * @file hoptest.c
+ * @brief Confere a aquisição de fase do salto de frequência (hop.c).
+ *
+ * Sem perda aleatória nem interferidor: cada cenário perde envios escolhidos
+ * da primeira rajada que o carrinho ouve (o último slot, o primeiro, um do
+ * meio) ou liga o carrinho no meio de uma rajada, e exige que, depois de
+ * travar, ele não perca mais nenhum envio por estar no canal errado. Uma fase
+ * errada por um slot inteiro aparece aqui como ~1/HOP_SLOTS de perda para
+ * sempre.
+ *
+ * Uso: hoptest (sai com erro se algum cenário falhar)
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include "hop.h"
+
+#define DWELLS      400                      // duração de cada cenário
+#define SETTLE_MS   (3 * HOP_LEN * HOP_DWELL_MS) // tempo para travar
+
+typedef struct {
+  const char *name;
+  uint8_t     drop;      // bits dos slots perdidos na primeira rajada ouvida
+  uint16_t    car_boot;  // ms em que o carrinho começa a ouvir
+} Scenario;
+
+static const Scenario scenarios[] = {
+  {"sem perda",                  0,                            0},
+  {"perde o último slot",        1 << (HOP_SLOTS - 1),         0},
+  {"perde o primeiro slot",      1 << 0,                       0},
+  {"perde um slot do meio",      1 << 1,                       0},
+  {"perde o primeiro e o último", 1 << 0 | 1 << (HOP_SLOTS - 1), 0},
+  {"liga no meio da rajada",     0,                            2 * HOP_PERIOD_MS + 3},
+};
+
+/**
+ * @return envios perdidos por canal errado depois de SETTLE_MS.
+ */
+static long run(const Scenario *sc, uint16_t *resyncs) {
+  HopTx tx;
+  HopRx rx;
+  hop_init(HOP_SEED);
+  hop_tx_begin(&tx, 0);
+  hop_rx_begin(&rx);
+
+  long missed = 0;
+  uint8_t tx_ch = hop_channel(tx.index), rx_ch = hop_channel(rx.index);
+
+  for (long t = 0; t < (long)DWELLS * HOP_DWELL_MS; t++) {
+    uint16_t now = (uint16_t)t;
+    int car_on = t >= sc->car_boot;
+
+    if (t % HOP_PERIOD_MS == 0) {
+      if (hop_tx_poll(&tx, now)) tx_ch = hop_channel(tx.index);
+      uint8_t slot = (uint16_t)(now - tx.start) / HOP_PERIOD_MS;
+      // O carrinho começa estacionado no canal 0: a primeira rajada é a dele
+      int lost = t < HOP_DWELL_MS && (sc->drop >> slot & 1);
+
+      if (car_on && !lost && rx_ch == tx_ch) {
+        hop_rx_packet(&rx, now);
+      } else if (car_on && !lost && t >= SETTLE_MS) {
+        missed++;
+      }
+    }
+    if (car_on && hop_rx_poll(&rx, now)) rx_ch = hop_channel(rx.index);
+  }
+  *resyncs = rx.resyncs;
+  return missed;
+}
+
+int main(void) {
+  int failed = 0;
+  long sent = (DWELLS * HOP_DWELL_MS - SETTLE_MS) / HOP_PERIOD_MS;
+
+  for (unsigned i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+    uint16_t resyncs;
+    long missed = run(&scenarios[i], &resyncs);
+    printf("%-5s %-30s fora de canal %5ld de %ld, ressinc %u\n", missed ? "FALHA" : "ok",
+           scenarios[i].name, missed, sent, resyncs);
+    if (missed) failed++;
+  }
+  return failed != 0;
+}
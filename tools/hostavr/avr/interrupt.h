@@ -0,0 +1,22 @@
+/**
+ * @file interrupt.h
+ * @brief ISRs viram funções comuns, que a ferramenta no PC chama.
+ *
+ * cli() e sei() só mexem no bit I do SREG: no PC não há interrupção de
+ * verdade, então as seções críticas do firmware continuam corretas.
+ */
+#ifndef HOSTAVR_INTERRUPT_H
+#define HOSTAVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define ISR(vector, ...)          void vector(void); void vector(void)
+#define EMPTY_INTERRUPT(vector)   void vector(void); void vector(void) {}
+#define ISR_ALIASOF(vector)
+#define ISR_NOBLOCK
+#define ISR_NAKED
+
+static inline void cli(void) { SREG &= ~0x80; }
+static inline void sei(void) { SREG |= 0x80; }
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ * @file io.h
+ * @brief avr/io.h do ATmega328P para compilar os firmwares no PC.
+ *
+ * Os registradores viram variáveis comuns (definidas em hostavr.c): o
+ * firmware escreve e lê como no AVR e a ferramenta no PC faz o papel do
+ * hardware, chamando as ISRs e olhando os pinos. Só tem o que os firmwares
+ * deste repositório usam.
+ */
+#ifndef HOSTAVR_IO_H
+#define HOSTAVR_IO_H
+
+#include <stdint.h>
+
+#ifdef HOSTAVR_DEFINE
+#define REG8(n)  volatile uint8_t n;
+#define REG16(n) volatile uint16_t n;
+#else
+#define REG8(n)  extern volatile uint8_t n;
+#define REG16(n) extern volatile uint16_t n;
+#endif
+
+// Portas
+REG8(PORTB) REG8(PORTC) REG8(PORTD) REG8(DDRB) REG8(DDRC) REG8(DDRD)
+REG8(PINB) REG8(PINC) REG8(PIND)
+// Timers
+REG8(TCCR0A) REG8(TCCR0B) REG8(TCNT0) REG8(OCR0A) REG8(OCR0B) REG8(TIMSK0) REG8(TIFR0)
+REG8(TCCR1A) REG8(TCCR1B) REG8(TCCR1C) REG16(TCNT1) REG16(OCR1A) REG16(OCR1B) REG16(ICR1)
+REG8(TIMSK1) REG8(TIFR1)
+REG8(TCCR2A) REG8(TCCR2B) REG8(TCNT2) REG8(OCR2A) REG8(OCR2B) REG8(TIMSK2) REG8(TIFR2)
+REG8(ASSR) REG8(GTCCR)
+// ADC
+REG8(ADMUX) REG8(ADCSRA) REG8(ADCSRB) REG16(ADC) REG8(ADCL) REG8(ADCH) REG8(DIDR0)
+// SPI, USART, interrupções de pino
+REG8(SPCR) REG8(SPSR) REG8(SPDR)
+REG8(UCSR0A) REG8(UCSR0B) REG8(UCSR0C) REG16(UBRR0) REG8(UDR0)
+REG8(PCICR) REG8(PCMSK0) REG8(PCMSK1) REG8(PCMSK2) REG8(PCIFR)
+// Sistema
+REG8(SREG) REG8(MCUSR) REG8(MCUCR) REG8(SMCR) REG8(PRR) REG8(WDTCSR)
+REG8(EECR) REG8(EEDR) REG16(EEAR) REG8(GPIOR0) REG8(GPIOR1) REG8(GPIOR2)
+
+#undef REG8
+#undef REG16
+
+#define E2END 0x3FF
+
+enum { PB0, PB1, PB2, PB3, PB4, PB5, PB6, PB7 };
+enum { PC0, PC1, PC2, PC3, PC4, PC5, PC6 };
+enum { PD0, PD1, PD2, PD3, PD4, PD5, PD6, PD7 };
+
+// Timer0
+#define WGM00 0
+#define WGM01 1
+#define COM0B0 4
+#define COM0B1 5
+#define COM0A0 6
+#define COM0A1 7
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define WGM02 3
+#define TOIE0 0
+#define OCIE0A 1
+#define OCIE0B 2
+#define TOV0 0
+#define OCF0A 1
+#define OCF0B 2
+// Timer1
+#define WGM10 0
+#define WGM11 1
+#define COM1B0 4
+#define COM1B1 5
+#define COM1A0 6
+#define COM1A1 7
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define WGM13 4
+#define ICES1 6
+#define ICNC1 7
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define ICIE1 5
+#define TOV1 0
+#define OCF1A 1
+#define OCF1B 2
+#define ICF1 5
+// Timer2
+#define WGM20 0
+#define WGM21 1
+#define COM2B0 4
+#define COM2B1 5
+#define COM2A0 6
+#define COM2A1 7
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define WGM22 3
+#define TOIE2 0
+#define OCIE2A 1
+#define OCIE2B 2
+#define TOV2 0
+#define OCF2A 1
+#define OCF2B 2
+#define AS2 5
+#define TCN2UB 4
+#define OCR2AUB 3
+#define OCR2BUB 2
+#define TCR2AUB 1
+#define TCR2BUB 0
+#define TSM 7
+#define PSRASY 1
+#define PSRSYNC 0
+// ADC
+#define REFS0 6
+#define REFS1 7
+#define ADLAR 5
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE 3
+#define ADIF 4
+#define ADATE 5
+#define ADSC 6
+#define ADEN 7
+#define ADTS0 0
+#define ADTS1 1
+#define ADTS2 2
+#define ADC0D 0
+#define ADC1D 1
+#define ADC2D 2
+#define ADC3D 3
+#define ADC4D 4
+#define ADC5D 5
+// SPI
+#define SPR0 0
+#define SPR1 1
+#define MSTR 4
+#define SPE 6
+#define SPIE 7
+#define SPI2X 0
+#define SPIF 7
+// USART
+#define RXC0 7
+#define TXC0 6
+#define UDRE0 5
+#define FE0 4
+#define DOR0 3
+#define UPE0 2
+#define U2X0 1
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN0 4
+#define TXEN0 3
+#define UCSZ01 2
+#define UCSZ00 1
+// Interrupções de pino
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define PCIF0 0
+#define PCIF1 1
+#define PCIF2 2
+#define PCINT8 0
+#define PCINT9 1
+#define PCINT10 2
+#define PCINT11 3
+// Reset, sono, energia e watchdog
+#define PORF 0
+#define EXTRF 1
+#define BORF 2
+#define WDRF 3
+#define SE 0
+#define SM0 1
+#define SM1 2
+#define SM2 3
+#define PRADC 0
+#define PRUSART0 1
+#define PRSPI 2
+#define PRTIM1 3
+#define PRTIM0 5
+#define PRTIM2 6
+#define PRTWI 7
+#define WDP0 0
+#define WDP1 1
+#define WDP2 2
+#define WDE 3
+#define WDCE 4
+#define WDP3 5
+#define WDIE 6
+#define WDIF 7
+// EEPROM
+#define EERE 0
+#define EEPE 1
+#define EEMPE 2
+
+#define _BV(b) (1 << (b))
+#define bit_is_set(s, b)   ((s) & _BV(b))
+#define bit_is_clear(s, b) (!((s) & _BV(b)))
+
+#endif
@@ -0,0 +1,17 @@
+/**
+ * @file pgmspace.h
+ * @brief Flash no PC: PROGMEM é memória comum.
+ */
+#ifndef HOSTAVR_PGMSPACE_H
+#define HOSTAVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define memcpy_P memcpy
+
+#endif
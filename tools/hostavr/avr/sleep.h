@@ -0,0 +1,22 @@
+/**
+ * @file sleep.h
+ * @brief Sono no PC: sleep_cpu() volta na hora (quem simula avança o tempo).
+ */
+#ifndef HOSTAVR_SLEEP_H
+#define HOSTAVR_SLEEP_H
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE      (0)
+#define SLEEP_MODE_ADC       (1 << SM0)
+#define SLEEP_MODE_PWR_DOWN  (1 << SM1)
+#define SLEEP_MODE_PWR_SAVE  ((1 << SM0) | (1 << SM1))
+#define SLEEP_MODE_STANDBY   ((1 << SM1) | (1 << SM2))
+
+#define set_sleep_mode(mode) (SMCR = (SMCR & ~((1 << SM0) | (1 << SM1) | (1 << SM2))) | (mode))
+#define sleep_enable()       (SMCR |= (1 << SE))
+#define sleep_disable()      (SMCR &= ~(1 << SE))
+#define sleep_cpu()          ((void)0)
+#define sleep_bod_disable()  ((void)0)
+
+#endif
@@ -0,0 +1,6 @@
+/**
+ * @file hostavr.c
+ * @brief Registradores do ATmega328P como variáveis, para os firmwares no PC.
+ */
+#define HOSTAVR_DEFINE
+#include <avr/io.h>
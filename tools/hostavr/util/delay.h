@@ -0,0 +1,11 @@
+/**
+ * @file delay.h
+ * @brief Esperas no PC: não esperam (quem simula avança o tempo).
+ */
+#ifndef HOSTAVR_DELAY_H
+#define HOSTAVR_DELAY_H
+
+#define _delay_us(us) ((void)(us))
+#define _delay_ms(ms) ((void)(ms))
+
+#endif
@@ -0,0 +1,260 @@
+/**
+ * @file ldrreplay.c
+ * @brief Passa traços do LDR pelo detector do firmware (ldr.c) no PC.
+ *
+ * Cada linha do traço é uma amostra do ADC, na taxa do firmware
+ * (LDR_SAMPLE_HZ), seguida do jogador que estava com o laser na mira ou -1:
+ *
+ *   123 -1
+ *   131 2
+ *
+ * Para cada traço mede os tiros falsos (sem laser ou com o jogador errado), os
+ * tiros perdidos (mira de pelo menos 1s sem detecção) e a latência entre o
+ * laser chegar e o tiro ser detectado. Compara com o limiar fixo antigo
+ * (analog_read() > 800, uma leitura por ms, borda de subida).
+ *
+ * Sem arquivo, gera um traço sintético: luz ambiente variando devagar, lâmpada
+ * de 100Hz, ruído, sombras, variação rápida com o movimento (-m) e tiros de
+ * jogadores aleatórios, com a luz passando por um LDR de primeira ordem. Com -g só escreve o traço gerado.
+ *
+ * Uso: ldrreplay [-g] [-d segundos] [-c contraste] [-t tau_ms] [-f lâmpada]
+ *                [-n ruído] [-a ambiente] [-m movimento] [-s semente] [traço]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <math.h>
+#include "ldr.h"
+
+static uint32_t rng = 1;
+static double frand(void) {
+  rng = rng * 1664525u + 1013904223u;
+  return (rng >> 8) / 16777216.0;
+}
+
+typedef struct {
+  double seconds;
+  double contrast;  // aumento no ADC com o laser aceso, sem o atraso do LDR
+  double tau_ms;    // constante de tempo do LDR
+  double flicker;   // amplitude da lâmpada de 100Hz
+  double noise;     // ruído uniforme, pico
+  double ambient;   // luz ambiente média
+  double motion;    // variação rápida da luz com o carrinho andando (até ~10Hz), RMS
+} Scene;
+
+/**
+ * @brief Gera o traço sintético, amostra por amostra.
+ */
+typedef struct {
+  Scene sc;
+  long n;
+  double y;          // saída do LDR (antes do ruído)
+  double shadow;     // sombra atual
+  double shadow_end;
+  int player;        // jogador na mira, -1 se ninguém
+  double shot_end;
+  double next_shot;
+  double phase_ms;   // fase do código do atirador
+  double wander[2];  // ruído branco filtrado duas vezes (variação com o movimento)
+} Synth;
+
+static const uint16_t codes[LASER_PLAYERS] = LASER_CODES;
+
+static void synth_begin(Synth *g, Scene sc) {
+  *g = (Synth){sc, 0, sc.ambient, 0, 0, -1, 0, 1 + 2 * frand(), 0, {0, 0}};
+}
+
+static int synth_next(Synth *g, uint8_t *value, int *label) {
+  double fs = LDR_SAMPLE_HZ;
+  double t = g->n++ / fs;
+  if (t >= g->sc.seconds) return 0;
+
+  if (g->player < 0 && t >= g->next_shot) {
+    g->player = (int)(frand() * LASER_PLAYERS);
+    g->shot_end = t + 0.3 + 2.2 * frand();
+    g->phase_ms = frand() * LASER_CHIP_MS * LASER_CODE_BITS;
+  } else if (g->player >= 0 && t >= g->shot_end) {
+    g->player = -1;
+    g->next_shot = t + 1 + 4 * frand();
+  }
+
+  if (t >= g->shadow_end) {
+    g->shadow = frand() < 0.3 ? -0.3 * g->sc.ambient * frand() : 0;
+    g->shadow_end = t + 0.2 + 3 * frand();
+  }
+
+  // Passa-baixa de 30ms duas vezes: a maior parte da energia fica abaixo de 10Hz
+  double k = 1 / (fs * 0.03);
+  g->wander[0] += (2 * frand() - 1 - g->wander[0]) * k;
+  g->wander[1] += (g->wander[0] - g->wander[1]) * k;
+
+  double light = g->sc.ambient * (1 + 0.4 * sin(2 * M_PI * t / 40)) + g->shadow
+               + g->sc.flicker * sin(2 * M_PI * 100 * t)
+               + g->sc.motion * g->wander[1] * 2 / (0.577 * sqrt(k));
+  if (g->player >= 0) {
+    long chip = (long)((t * 1000 + g->phase_ms) / LASER_CHIP_MS);
+    if ((codes[g->player] >> (chip % LASER_CODE_BITS)) & 1) light += g->sc.contrast;
+  }
+
+  g->y += (light - g->y) / (fs * g->sc.tau_ms / 1000);
+  double v = g->y + g->sc.noise * (2 * frand() - 1);
+  *value = v < 0 ? 0 : v > 255 ? 255 : (uint8_t)v;
+  *label = g->player;
+  return 1;
+}
+
+typedef struct {
+  long shots;       // mira de pelo menos 1s
+  long detected;    // tiros certos (um por mira)
+  long false_hits;  // sem laser na mira
+  long wrong;       // jogador errado
+  double latency_sum;
+  double latency_max;
+  double idle_s;    // tempo sem laser na mira
+} Score;
+
+/**
+ * @brief Confere um tiro detectado contra o rótulo do traço.
+ */
+typedef struct {
+  int label;
+  double onset;     // início da mira atual
+  int hit;          // a mira atual já foi detectada
+  int last;         // jogador da última mira que terminou
+  double last_end;
+  int last_hit;
+} Truth;
+
+#define LATE_S 1.5  // tiro detectado até 1,5s depois de a mira sair ainda conta
+
+static void truth_step(Truth *tr, Score *s, int label, double t, double dt) {
+  if (label != tr->label) {
+    if (tr->label >= 0 && t - tr->onset >= 1.0) {
+      s->shots++;
+      if (tr->hit) s->detected++;
+    }
+    if (tr->label >= 0) {
+      tr->last = tr->label;
+      tr->last_end = t;
+      tr->last_hit = tr->hit;
+    }
+    tr->label = label;
+    tr->onset = t;
+    tr->hit = 0;
+  }
+  if (label < 0) s->idle_s += dt;
+}
+
+static void truth_hit(Truth *tr, Score *s, int shooter, double t) {
+  if (tr->label < 0 && t - tr->last_end < LATE_S && !tr->last_hit &&
+      (shooter < 0 || shooter == tr->last)) {
+    tr->last_hit = 1;  // mira curta, detectada depois de sair
+  } else if (tr->label < 0) {
+    s->false_hits++;
+  } else if (shooter >= 0 && shooter != tr->label) {
+    s->wrong++;
+  } else if (!tr->hit) {
+    double lat = t - tr->onset;
+    tr->hit = 1;
+    s->latency_sum += lat;
+    if (lat > s->latency_max) s->latency_max = lat;
+  }
+}
+
+static void report(const char *name, Score s) {
+  double hits = s.detected ? s.detected : 1;
+  printf("  %-14s mira>=1s %4ld  detectados %5.1f%%  falsos %5ld (%.2f/min)  jogador errado %4ld  latência média %.2fs máx %.2fs\n",
+         name, s.shots, s.shots ? 100.0 * s.detected / s.shots : 0, s.false_hits,
+         s.idle_s > 0 ? 60 * s.false_hits / s.idle_s : 0, s.wrong,
+         s.latency_sum / hits, s.latency_max);
+}
+
+int main(int argc, char **argv) {
+  Scene sc = {600, 40, 20, 10, 4, 120, 0};
+  int generate = 0, opt;
+
+  while ((opt = getopt(argc, argv, "gd:c:t:f:n:a:m:s:")) != -1) {
+    switch (opt) {
+    case 'g': generate = 1; break;
+    case 'd': sc.seconds = atof(optarg); break;
+    case 'c': sc.contrast = atof(optarg); break;
+    case 't': sc.tau_ms = atof(optarg); break;
+    case 'f': sc.flicker = atof(optarg); break;
+    case 'n': sc.noise = atof(optarg); break;
+    case 'a': sc.ambient = atof(optarg); break;
+    case 'm': sc.motion = atof(optarg); break;
+    case 's': rng = (uint32_t)atol(optarg); break;
+    default:
+      fprintf(stderr, "uso: %s [-g] [-d segundos] [-c contraste] [-t tau_ms] [-f lâmpada] [-n ruído] [-a ambiente] [-m movimento] [-s semente] [traço]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  FILE *in = NULL;
+  if (optind < argc && !(in = fopen(argv[optind], "r"))) {
+    perror(argv[optind]);
+    return 1;
+  }
+
+  Synth g;
+  synth_begin(&g, sc);
+
+  LdrDetector det;
+  ldr_begin(&det);
+  Score adaptive = {0}, legacy = {0};
+  Truth ta = {-1, 0, 0, -1, -LATE_S, 0}, tl = ta;
+  int legacy_prev = 0;
+  uint16_t threshold_min = INT16_MAX, threshold_max = 0;
+  uint8_t ambient_min = 255, ambient_max = 0;
+
+  double dt = 1.0 / LDR_SAMPLE_HZ;
+  long n = 0;
+  for (;;) {
+    uint8_t value;
+    int label;
+    if (in) {
+      int v;
+      if (fscanf(in, "%d %d", &v, &label) != 2) break;
+      value = v < 0 ? 0 : v > 255 ? 255 : v;
+    } else if (!synth_next(&g, &value, &label)) {
+      break;
+    }
+
+    if (generate) {
+      printf("%u %d\n", value, label);
+      continue;
+    }
+
+    double t = n++ * dt;
+    truth_step(&ta, &adaptive, label, t, dt);
+    truth_step(&tl, &legacy, label, t, dt);
+
+    uint8_t shooter = ldr_sample(&det, value);
+    if (shooter) truth_hit(&ta, &adaptive, shooter - 1, t);
+    if (det.warm >= LDR_RING) {
+      if (det.threshold < threshold_min) threshold_min = det.threshold;
+      if (det.threshold > threshold_max) threshold_max = det.threshold;
+      if (LDR_AMBIENT(&det) < ambient_min) ambient_min = LDR_AMBIENT(&det);
+      if (LDR_AMBIENT(&det) > ambient_max) ambient_max = LDR_AMBIENT(&det);
+    }
+
+    // Limiar fixo antigo: 800 de 1023 no ADC de 10 bits, lido uma vez por ms
+    if (n % (LDR_SAMPLE_HZ / 1000) == 0) {
+      int bright = value > 800 / 4;
+      if (bright && !legacy_prev) truth_hit(&tl, &legacy, -1, t);
+      legacy_prev = bright;
+    }
+  }
+  if (in) fclose(in);
+  if (generate) return 0;
+
+  truth_step(&ta, &adaptive, -2, n * dt, 0);
+  truth_step(&tl, &legacy, -2, n * dt, 0);
+
+  printf("%.0fs de traço, %.0fs sem laser na mira; luz ambiente entre %u e %u; limiar do correlador entre %u e %u (mínimo %lu)\n",
+         n * dt, adaptive.idle_s, ambient_min, ambient_max, threshold_min, threshold_max, (unsigned long)LDR_HIT_MIN);
+  report("adaptativo", adaptive);
+  report("fixo (800)", legacy);
+  return 0;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file linksim.c
+ * @brief Simulador do enlace controle -> carrinho no PC.
+ *
+ * Roda a mesma lógica de salto de frequência do firmware (hop.c) contra um
+ * modelo de canal com perda base e um interferidor de banda estreita, em
+ * passos de 1ms. Compara o canal fixo (76) com o modo de salto.
+ *
+ * Em seguida compara, para várias taxas de perda, a retransmissão automática
+ * do rádio com quadros redundantes sem retransmissão (frame.c compilado com
+ * FRAME_REDUNDANCY=4): perda efetiva de comandos e latência de entrega.
+ *
+ * Uso: linksim [-n envios] [-j canal] [-w largura] [-p perda%] [-J perda%]
+ *              [-d ppm] [-s semente] [-b rajada_ms]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <math.h>
+#include "hop.h"
+#include "frame.h"
+
+typedef struct {
+  long sent;
+  long received;
+  long jammed;   // perdidos no canal do interferidor
+  long missed;   // perdidos porque o carrinho estava em outro canal
+  uint16_t resyncs;
+} Stats;
+
+static uint32_t rng = 12345;
+static double frand(void) {
+  rng = rng * 1664525u + 1013904223u;
+  return (rng >> 8) / 16777216.0;
+}
+
+static int jam_center = 76, jam_width = 3;
+static double base_loss = 0.01, jam_loss = 0.95;
+
+static double channel_loss(uint8_t ch) {
+  int d = ch - jam_center;
+  if (d < 0) d = -d;
+  return (jam_width > 0 && d <= jam_width / 2) ? jam_loss : base_loss;
+}
+
+/**
+ * @brief Simula `packets` envios do controle.
+ * @param hopping 0 = canal fixo 76, 1 = salto de frequência.
+ * @param ppm desvio do cristal do carrinho em relação ao controle.
+ */
+static Stats simulate(long packets, int hopping, int ppm) {
+  Stats st = {0};
+  HopTx tx;
+  HopRx rx;
+  hop_init(HOP_SEED);
+  hop_tx_begin(&tx, 0);
+  hop_rx_begin(&rx);
+
+  // Começa o carrinho em um ponto qualquer da sequência
+  rx.index = (uint8_t)(frand() * HOP_LEN);
+  uint8_t rx_ch = hopping ? hop_channel(rx.index) : 76;
+  uint8_t tx_ch = hopping ? hop_channel(tx.index) : 76;
+  double car_clock = frand() * 1000;
+
+  for (long t = 0; st.sent < packets; t++) {
+    uint16_t now_tx = (uint16_t)t;
+    car_clock += 1.0 + ppm * 1e-6;
+    uint16_t now_rx = (uint16_t)(long)car_clock;
+
+    if (t % HOP_PERIOD_MS == 0) {
+      if (hopping && hop_tx_poll(&tx, now_tx)) tx_ch = hop_channel(tx.index);
+      st.sent++;
+
+      if (frand() < channel_loss(tx_ch)) {
+        if (channel_loss(tx_ch) > base_loss) st.jammed++;
+      } else if (rx_ch != tx_ch) {
+        st.missed++;
+      } else {
+        st.received++;
+        if (hopping) hop_rx_packet(&rx, now_rx);
+      }
+    }
+
+    if (hopping && hop_rx_poll(&rx, now_rx)) rx_ch = hop_channel(rx.index);
+  }
+  st.resyncs = rx.resyncs;
+  return st;
+}
+
+static void report(const char *name, Stats st) {
+  long lost = st.sent - st.received;
+  printf("%-12s enviados %7ld  recebidos %7ld  perda %6.2f%%  (interferência %ld, fora de canal %ld, ressinc %u)\n",
+         name, st.sent, st.received, 100.0 * lost / st.sent, st.jammed, st.missed, st.resyncs);
+}
+
+/*
+ Tempos do nRF24L01+ a 1Mbps: 130us para o PLL estabilizar antes de cada
+ envio e 8us por bit no ar (preâmbulo, endereço de 5 bytes, 9 bits de controle,
+ carga e CRC de 2 bytes). Cada retransmissão espera ARD (250us) + o ar de novo.
+*/
+#define T_SETTLE_US 130
+#define T_ARD_US    250
+static double airtime_us(int payload) {
+  return (1 + 5 + payload + 2) * 8 + 9;
+}
+
+/**
+ * @brief Canal com rajadas de perda (modelo de Gilbert em tempo contínuo).
+ *
+ * Fica em "ruim" (tudo se perde) por burst_us em média e em "bom" pelo tempo
+ * que dá a perda média pedida. Com burst_us = 0 cada envio se perde de forma
+ * independente.
+ */
+typedef struct {
+  double loss;
+  double burst_us;
+  double next_switch;
+  int bad;
+} Channel;
+
+static double exprand(double mean) {
+  double u = frand();
+  return -mean * log(1.0 - u);
+}
+
+static int channel_lost(Channel *ch, double t_us) {
+  if (ch->burst_us <= 0) return frand() < ch->loss;
+
+  double good_us = ch->burst_us * (1 - ch->loss) / ch->loss;
+  while (t_us >= ch->next_switch) {
+    ch->bad = !ch->bad;
+    ch->next_switch += exprand(ch->bad ? ch->burst_us : good_us);
+  }
+  return ch->bad;
+}
+
+static double burst_ms = 0;
+
+typedef struct {
+  long commands;
+  long delivered;
+  double latency_sum;  // us
+  double latency_max;
+} Delivery;
+
+/**
+ * @brief Retransmissão automática: cada comando tenta até retries+1 vezes.
+ */
+static Delivery simulate_arq(long commands, double loss, int retries) {
+  Delivery d = {0};
+  Channel ch = {loss, burst_ms * 1000, 0, 0};
+  double air = airtime_us(5);
+  for (d.commands = 0; d.commands < commands; d.commands++) {
+    double t = d.commands * HOP_PERIOD_MS * 1000.0;
+    for (int k = 0; k <= retries; k++) {
+      if (!channel_lost(&ch, t + T_SETTLE_US + k * (T_ARD_US + air))) {
+        double lat = T_SETTLE_US + air + k * (T_ARD_US + air);
+        d.delivered++;
+        d.latency_sum += lat;
+        if (lat > d.latency_max) d.latency_max = lat;
+        break;
+      }
+    }
+  }
+  return d;
+}
+
+/**
+ * @brief Quadros redundantes sem retransmissão, pelo código do firmware.
+ *
+ * Um comando perdido chega junto com o próximo quadro aceito, k períodos depois.
+ */
+static Delivery simulate_redundant(long commands, double loss, uint8_t depth) {
+  Delivery d = {0};
+  Channel ch = {loss, burst_ms * 1000, 0, 0};
+  FrameTx tx;
+  FrameRx rx;
+  frame_tx_begin(&tx, depth);
+  frame_rx_begin(&rx);
+  double air = airtime_us(sizeof(Frame));
+
+  for (d.commands = 0; d.commands < commands; d.commands++) {
+    Controls c = {(int8_t)(d.commands & 0x7F), 0, 0, 0};
+    Frame f;
+    uint16_t now = (uint16_t)(d.commands * HOP_PERIOD_MS);
+    frame_tx_encode(&tx, &f, &c, now);
+    if (channel_lost(&ch, d.commands * HOP_PERIOD_MS * 1000.0 + T_SETTLE_US)) continue;
+    if (!frame_rx_accept(&rx, &f, now)) continue;
+
+    d.delivered++;
+    d.latency_sum += T_SETTLE_US + air;
+    uint8_t recovered = rx.gap < depth ? rx.gap : depth;
+    for (uint8_t k = 1; k <= recovered; k++) {
+      double lat = T_SETTLE_US + air + k * HOP_PERIOD_MS * 1000.0;
+      d.delivered++;
+      d.latency_sum += lat;
+      if (lat > d.latency_max) d.latency_max = lat;
+    }
+    if (T_SETTLE_US + air > d.latency_max) d.latency_max = T_SETTLE_US + air;
+  }
+  return d;
+}
+
+static void report_delivery(Delivery d) {
+  printf("  %6.2f%% %7.0f %7.0f |", 100.0 * (d.commands - d.delivered) / d.commands,
+         d.delivered ? d.latency_sum / d.delivered : 0, d.latency_max);
+}
+
+static void benchmark_redundancy(long commands) {
+  static const double losses[] = {0.01, 0.05, 0.10, 0.20, 0.30, 0.40};
+
+  printf("\nperda de comandos x latência (us): perda%% média máx, %ld comandos, período %dms, ",
+         commands, HOP_PERIOD_MS);
+  if (burst_ms > 0) printf("rajadas de %.1fms em média\n", burst_ms);
+  else printf("perdas independentes\n");
+  printf("perda   |        ARQ 3       |        ARQ 15      |   redund. 1 s/ARQ  |   redund. 4 s/ARQ  |\n");
+  for (unsigned i = 0; i < sizeof(losses) / sizeof(losses[0]); i++) {
+    printf("%5.0f%%  |", losses[i] * 100);
+    report_delivery(simulate_arq(commands, losses[i], 3));
+    report_delivery(simulate_arq(commands, losses[i], 15));
+    report_delivery(simulate_redundant(commands, losses[i], 1));
+    report_delivery(simulate_redundant(commands, losses[i], 4));
+    printf("\n");
+  }
+}
+
+int main(int argc, char **argv) {
+  long packets = 100000;
+  int ppm = 50, opt;
+
+  while ((opt = getopt(argc, argv, "n:j:w:p:J:d:s:b:")) != -1) {
+    switch (opt) {
+    case 'n': packets = atol(optarg); break;
+    case 'j': jam_center = atoi(optarg); break;
+    case 'w': jam_width = atoi(optarg); break;
+    case 'p': base_loss = atof(optarg) / 100; break;
+    case 'J': jam_loss = atof(optarg) / 100; break;
+    case 'd': ppm = atoi(optarg); break;
+    case 's': rng = (uint32_t)atol(optarg); break;
+    case 'b': burst_ms = atof(optarg); break;
+    default:
+      fprintf(stderr, "uso: %s [-n envios] [-j canal] [-w largura] [-p perda%%] [-J perda%%] [-d ppm] [-s semente] [-b rajada_ms]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  printf("interferidor: canal %d, largura %d MHz, perda %.0f%% (base %.1f%%), desvio %d ppm\n",
+         jam_center, jam_width, jam_loss * 100, base_loss * 100, ppm);
+  report("fixo (76)", simulate(packets, 0, ppm));
+  report("salto", simulate(packets, 1, ppm));
+
+  benchmark_redundancy(packets);
+  return 0;
+}
@@ -0,0 +1,265 @@
+/**
+ * @file matchlog.c
+ * @brief Registro da partida (matchlog.h).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "matchlog.h"
+
+#define LOG_RESERVE (1ull << 34)  // 16GiB de endereços: ~500 milhões de eventos
+#define LOG_STEP    (4u << 20)    // o .log cresce de 4MB em 4MB
+#define IDX_RESERVE (1ull << 31)
+#define IDX_STEP    (64 * sizeof(MatchIdxBlock))
+
+static MatchIdxBlock *block(const MatchLog *m, uint32_t b) {
+  return (MatchIdxBlock *)m->idx + b;
+}
+
+static int grow(int fd, size_t *size, size_t need, size_t step, size_t reserve, const char *what) {
+  if (need <= *size) return 0;
+  size_t n = (need + step - 1) / step * step;
+  if (n > reserve || ftruncate(fd, n) < 0) {
+    fprintf(stderr, "matchlog: sem espaço para o %s (%zu bytes)\n", what, n);
+    return -1;
+  }
+  *size = n;
+  return 0;
+}
+
+static void *map(int fd, size_t reserve, int writable) {
+  void *p = mmap(NULL, reserve, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
+  return p == MAP_FAILED ? NULL : p;
+}
+
+/*** Índice ***/
+
+static int idx_add(MatchLog *m, uint8_t car, uint32_t ev, uint64_t t) {
+  MatchIdxHeader *h = m->idx;
+  uint32_t b = h->tail[car];
+
+  if (!b || block(m, b)->n == MATCHIDX_PER_BLOCK) {
+    uint32_t nb = h->blocks;
+    if (grow(m->idx_fd, &m->idx_size, (nb + 1) * sizeof(MatchIdxBlock), IDX_STEP, IDX_RESERVE, "índice") < 0)
+      return -1;
+    memset(block(m, nb), 0, sizeof(MatchIdxBlock));
+    h->blocks = nb + 1;
+    if (b) block(m, b)->next = nb;
+    else h->head[car] = nb;
+    h->tail[car] = b = nb;
+  }
+
+  MatchIdxBlock *k = block(m, b);
+  if (!k->n) k->first_us = t;
+  k->last_us = t;
+  k->ev[k->n++] = ev;
+  h->count[car]++;
+  return 0;
+}
+
+static void idx_reset(MatchLog *m) {
+  memset(m->idx, 0, sizeof(MatchIdxHeader));
+  m->idx->magic = MATCHLOG_MAGIC;
+  m->idx->version = MATCHLOG_VERSION;
+  m->idx->blocks = 1;
+}
+
+/**
+ * @brief Refaz o índice inteiro a partir dos eventos.
+ */
+static int idx_rebuild(MatchLog *m) {
+  idx_reset(m);
+  for (uint64_t i = 0; i < m->hdr->count; i++) {
+    const MatchEvent *e = &m->ev[i];
+    if (e->car < MATCHLOG_CARS && idx_add(m, e->car, i, e->t_us) < 0) return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Descarta entradas de eventos que não chegaram a ser contados (o
+ * based parou entre o índice e o count).
+ */
+static void idx_trim(MatchLog *m) {
+  MatchIdxHeader *h = m->idx;
+  uint64_t count = m->hdr->count;
+
+  for (int c = 0; c < MATCHLOG_CARS; c++) {
+    uint64_t kept = 0;
+    for (uint32_t b = h->head[c]; b; b = block(m, b)->next) {
+      MatchIdxBlock *k = block(m, b);
+      uint32_t n = 0;
+      while (n < k->n && k->ev[n] < count) n++;
+      kept += n;
+      if (n < k->n || !k->next) {
+        k->n = n;
+        if (n) k->last_us = m->ev[k->ev[n - 1]].t_us;
+        k->next = 0;
+        h->tail[c] = b;
+        break;
+      }
+    }
+    h->count[c] = kept;
+  }
+}
+
+static int idx_valid(const MatchLog *m) {
+  const MatchIdxHeader *h = m->idx;
+  if (m->idx_size < sizeof(MatchIdxHeader) || h->magic != MATCHLOG_MAGIC || h->version != MATCHLOG_VERSION)
+    return 0;
+  if (!h->blocks || (uint64_t)h->blocks * sizeof(MatchIdxBlock) > m->idx_size) return 0;
+  for (int c = 0; c < MATCHLOG_CARS; c++)
+    if (h->head[c] >= h->blocks || h->tail[c] >= h->blocks) return 0;
+  return 1;
+}
+
+/*** Registro ***/
+
+int matchlog_open(MatchLog *m, const char *path, int writable) {
+  struct stat st;
+  char idx_path[4096];
+
+  memset(m, 0, sizeof(*m));
+  m->writable = writable;
+  m->fd = open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+  if (m->fd < 0 || fstat(m->fd, &st) < 0) {
+    perror(path);
+    return -1;
+  }
+  m->size = st.st_size;
+  int fresh = m->size == 0;
+  if (fresh && (!writable || grow(m->fd, &m->size, sizeof(MatchLogHeader), LOG_STEP, LOG_RESERVE, "registro") < 0)) {
+    fprintf(stderr, "%s: vazio\n", path);
+    return -1;
+  }
+  if (!(m->hdr = map(m->fd, LOG_RESERVE, writable))) {
+    perror("mmap");
+    return -1;
+  }
+  m->ev = (MatchEvent *)(m->hdr + 1);
+  if (fresh) {
+    struct timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    *m->hdr = (MatchLogHeader){MATCHLOG_MAGIC, MATCHLOG_VERSION, sizeof(MatchEvent), 0,
+                               t.tv_sec * 1000000ull + t.tv_nsec / 1000, 0, {0}};
+  }
+  if (m->hdr->magic != MATCHLOG_MAGIC || m->hdr->version != MATCHLOG_VERSION ||
+      m->hdr->event_size != sizeof(MatchEvent) ||
+      sizeof(MatchLogHeader) + m->hdr->count * sizeof(MatchEvent) > m->size) {
+    fprintf(stderr, "%s: não é um registro de partida (versão %d)\n", path, MATCHLOG_VERSION);
+    return -1;
+  }
+
+  snprintf(idx_path, sizeof(idx_path), "%s.idx", path);
+  m->idx_fd = open(idx_path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+  if (m->idx_fd < 0 || fstat(m->idx_fd, &st) < 0) {
+    perror(idx_path);
+    return -1;
+  }
+  m->idx_size = st.st_size;
+  if (writable && grow(m->idx_fd, &m->idx_size, sizeof(MatchIdxHeader), IDX_STEP, IDX_RESERVE, "índice") < 0)
+    return -1;
+  if (!m->idx_size || !(m->idx = map(m->idx_fd, IDX_RESERVE, writable))) {
+    fprintf(stderr, "%s: índice ausente (abra uma vez com o based para refazer)\n", idx_path);
+    return -1;
+  }
+  if (!idx_valid(m)) {
+    if (!writable) {
+      fprintf(stderr, "%s: índice inválido (abra uma vez com o based para refazer)\n", idx_path);
+      return -1;
+    }
+    if (m->hdr->count) fprintf(stderr, "%s: refazendo o índice de %llu eventos\n", idx_path,
+                               (unsigned long long)m->hdr->count);
+    if (idx_rebuild(m) < 0) return -1;
+  } else if (writable) {
+    idx_trim(m);
+  }
+  return 0;
+}
+
+void matchlog_close(MatchLog *m) {
+  if (m->hdr) munmap(m->hdr, LOG_RESERVE);
+  if (m->idx) munmap(m->idx, IDX_RESERVE);
+  if (m->fd > 0) close(m->fd);
+  if (m->idx_fd > 0) close(m->idx_fd);
+  memset(m, 0, sizeof(*m));
+}
+
+int matchlog_append(MatchLog *m, const MatchEvent *e) {
+  uint64_t n = m->hdr->count;
+
+  if (e->car >= MATCHLOG_CARS || (n && e->t_us < m->ev[n - 1].t_us) || n >= UINT32_MAX) {
+    fprintf(stderr, "matchlog: evento fora de ordem ou de carrinho inválido\n");
+    return -1;
+  }
+  if (grow(m->fd, &m->size, sizeof(MatchLogHeader) + (n + 1) * sizeof(MatchEvent), LOG_STEP, LOG_RESERVE,
+           "registro") < 0)
+    return -1;
+  m->ev[n] = *e;
+  if (idx_add(m, e->car, n, e->t_us) < 0) return -1;
+  // Só agora o evento existe para quem lê
+  __atomic_store_n(&m->hdr->count, n + 1, __ATOMIC_RELEASE);
+  return 0;
+}
+
+uint64_t matchlog_seek(const MatchLog *m, uint64_t t) {
+  uint64_t lo = 0, hi = __atomic_load_n(&m->hdr->count, __ATOMIC_ACQUIRE);
+  while (lo < hi) {
+    uint64_t mid = lo + (hi - lo) / 2;
+    if (m->ev[mid].t_us < t) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+void matchlog_car_range(const MatchLog *m, MatchIter *it, uint8_t car, uint64_t t0, uint64_t t1) {
+  *it = (MatchIter){m, 0, 0, t1};
+  if (car >= MATCHLOG_CARS) return;
+
+  uint32_t b = m->idx->head[car];
+  while (b && block(m, b)->last_us < t0) b = block(m, b)->next;
+  if (!b) return;
+
+  const MatchIdxBlock *k = block(m, b);
+  uint32_t lo = 0, hi = k->n;
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    if (m->ev[k->ev[mid]].t_us < t0) lo = mid + 1;
+    else hi = mid;
+  }
+  it->block = b;
+  it->i = lo;
+}
+
+const MatchEvent *matchlog_car_next(MatchIter *it) {
+  uint64_t count = __atomic_load_n(&it->m->hdr->count, __ATOMIC_ACQUIRE);
+
+  while (it->block) {
+    const MatchIdxBlock *k = block(it->m, it->block);
+    if (it->i >= k->n) {
+      it->block = k->next;
+      it->i = 0;
+      continue;
+    }
+    uint32_t ev = k->ev[it->i];
+    if (ev >= count || it->m->ev[ev].t_us > it->t1) break;
+    it->i++;
+    return &it->m->ev[ev];
+  }
+  it->block = 0;
+  return NULL;
+}
+
+const MatchEvent *matchlog_car_last(const MatchLog *m, uint8_t car) {
+  if (car >= MATCHLOG_CARS) return NULL;
+  uint64_t count = __atomic_load_n(&m->hdr->count, __ATOMIC_ACQUIRE);
+  const MatchIdxBlock *k = block(m, m->idx->tail[car]);
+  for (uint32_t i = k->n; m->idx->tail[car] && i; i--)
+    if (k->ev[i - 1] < count) return &m->ev[k->ev[i - 1]];
+  return NULL;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file matchlog.h
+ * @brief Registro de uma partida: eventos de tamanho fixo num arquivo só de
+ *        acréscimo, mapeado em memória, com índice por carrinho e tempo.
+ *
+ * partida.log tem um cabeçalho e os eventos em ordem de tempo; como todos
+ * têm 32 bytes, o evento i está num endereço fixo e uma busca por tempo é
+ * uma busca binária direto no mapa. partida.log.idx guarda, para cada
+ * carrinho, a lista dos números dos seus eventos em blocos encadeados de
+ * 4kB, cada um com o tempo do primeiro e do último: consultar um carrinho
+ * numa janela pula os blocos de fora e faz busca binária no de dentro, sem
+ * passar pelos eventos dos outros.
+ *
+ * O evento só passa a existir quando count no cabeçalho do .log avança,
+ * depois de gravado e indexado: quem lê ao mesmo tempo (matchq durante a
+ * partida) ou um based que caiu no meio de um acréscimo nunca vê um evento
+ * pela metade. Ao abrir, entradas do índice além de count são descartadas,
+ * e um .idx que falta ou não confere é refeito a partir do .log.
+ *
+ * Os dois arquivos crescem em passos (ftruncate) dentro de uma reserva fixa
+ * de endereços, então os ponteiros do mapa não mudam durante a partida.
+ */
+#ifndef MATCHLOG_H
+#define MATCHLOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "report.h"
+
+#define MATCHLOG_MAGIC   0x474f4c4d  // "MLOG"
+#define MATCHLOG_VERSION 1
+#define MATCHLOG_CARS    REPORT_PIPES
+
+typedef enum {
+  MATCH_REPORT = 1, // relatório recebido (estado completo do carrinho)
+  MATCH_HIT,        // um tiro recebido, de shooter (sai dos contadores do relatório)
+  MATCH_BOOT,       // o carrinho reiniciou: os contadores dele recomeçam
+} MatchKind;
+
+/**
+ * @brief Um evento. hits_by é o acumulado da partida (a soma dos boots), não
+ * o contador do carrinho.
+ */
+typedef struct {
+  uint64_t t_us;        // hora do PC (us desde 1970)
+  uint16_t car_ms;      // relógio do carrinho
+  uint16_t accepted;    // enlace controle -> carrinho, desde o boot dele
+  uint16_t lost;
+  uint16_t hits_by[REPORT_SHOOTERS];
+  uint8_t  car;         // pipe da base (LASER_PLAYER)
+  uint8_t  kind;        // MatchKind
+  uint8_t  seq;
+  uint8_t  life;
+  uint8_t  shooter;     // MATCH_HIT
+  uint8_t  flags;       // REPORT_* do relatório
+  uint8_t  gap;         // relatórios deste carrinho perdidos logo antes deste
+  uint8_t  latency;
+} MatchEvent;
+static_assert(sizeof(MatchEvent) == 32);
+
+typedef struct {
+  uint32_t magic, version;
+  uint32_t event_size;
+  uint32_t reserved;
+  uint64_t start_us;    // criação do registro
+  volatile uint64_t count; // eventos completos
+  uint8_t  pad[32];
+} MatchLogHeader;
+static_assert(sizeof(MatchLogHeader) == 64);
+
+#define MATCHIDX_PER_BLOCK 1018
+
+typedef struct {
+  uint32_t next;        // próximo bloco do mesmo carrinho (0 = último)
+  uint32_t n;
+  uint64_t first_us, last_us;
+  uint32_t ev[MATCHIDX_PER_BLOCK];
+} MatchIdxBlock;
+static_assert(sizeof(MatchIdxBlock) == 4096);
+
+typedef struct {
+  uint64_t count[MATCHLOG_CARS]; // eventos de cada carrinho
+  uint32_t magic, version;
+  uint32_t blocks;      // blocos em uso (o 0 é este cabeçalho)
+  uint32_t head[MATCHLOG_CARS], tail[MATCHLOG_CARS];
+  uint8_t  pad[4096 - 8 * MATCHLOG_CARS - 12 - 8 * MATCHLOG_CARS];
+} MatchIdxHeader;
+static_assert(sizeof(MatchIdxHeader) == 4096);
+
+typedef struct {
+  int             fd, idx_fd;
+  int             writable;
+  MatchLogHeader *hdr;
+  MatchEvent     *ev;       // hdr + 1
+  size_t          size;     // bytes do .log no disco
+  MatchIdxHeader *idx;      // bloco 0
+  size_t          idx_size;
+} MatchLog;
+
+/**
+ * @brief Abre (e, com writable, cria) o registro e o índice.
+ * @return 0, ou -1 com a mensagem do erro já impressa.
+ */
+int  matchlog_open(MatchLog *m, const char *path, int writable);
+void matchlog_close(MatchLog *m);
+
+/**
+ * @brief Acrescenta um evento; t_us não pode voltar no tempo.
+ * @return 0, ou -1 se o disco ou a reserva acabou.
+ */
+int matchlog_append(MatchLog *m, const MatchEvent *e);
+
+static inline uint64_t matchlog_count(const MatchLog *m) { return m->hdr->count; }
+
+/**
+ * @brief Primeiro evento com t_us >= t (busca binária; count se nenhum).
+ */
+uint64_t matchlog_seek(const MatchLog *m, uint64_t t);
+
+/**
+ * @brief Eventos de um carrinho numa janela de tempo, em ordem.
+ */
+typedef struct {
+  const MatchLog *m;
+  uint32_t block, i;
+  uint64_t t1;
+} MatchIter;
+
+void matchlog_car_range(const MatchLog *m, MatchIter *it, uint8_t car, uint64_t t0, uint64_t t1);
+const MatchEvent *matchlog_car_next(MatchIter *it);
+
+/**
+ * @brief Último evento de um carrinho (NULL se nenhum), sem percorrer nada.
+ */
+const MatchEvent *matchlog_car_last(const MatchLog *m, uint8_t car);
+
+#endif
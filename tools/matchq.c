@@ -0,0 +1,126 @@
+/**
+ * @file matchq.c
+ * @brief Consulta o registro da partida (matchlog.h) sem percorrê-lo.
+ *
+ * Sem opções imprime o placar: para cada carrinho o último evento (direto
+ * do fim da lista dele no índice) traz os acertos acumulados de cada
+ * jogador, então o placar custa seis leituras com qualquer tamanho de
+ * partida. Pode rodar com o based gravando: só vê eventos completos.
+ *
+ * -c lista os eventos de um carrinho, pelo índice; -t limita a uma janela
+ * em segundos desde o começo do registro (-t 60,120; só -t 60 é até o fim).
+ * -t sem -c lista todos os carrinhos na janela, a partir de uma busca
+ * binária pelo tempo. -k filtra um tipo (report, hit, boot). Cada consulta
+ * diz quanto tempo levou.
+ *
+ * Uso: matchq [-c carro] [-t ini[,fim]] [-k tipo] [-q] partida.log
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "matchlog.h"
+
+static const char *kinds[] = {[MATCH_REPORT] = "report", [MATCH_HIT] = "hit", [MATCH_BOOT] = "boot"};
+
+static double now_s(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void print_event(const MatchLog *m, const MatchEvent *e) {
+  printf("%12.3f %4u %-6s %3u %4u %3u %3u %5u %5u %3u ", (e->t_us - m->hdr->start_us) / 1e6, e->car,
+         kinds[e->kind], e->seq, e->gap, e->life, e->latency, e->accepted, e->lost, e->flags);
+  if (e->kind == MATCH_HIT) printf("%3u ", e->shooter);
+  else printf("  - ");
+  for (int s = 0; s < REPORT_SHOOTERS; s++) printf(" %4u", e->hits_by[s]);
+  printf("\n");
+}
+
+static void scoreboard(const MatchLog *m) {
+  uint32_t scored[REPORT_SHOOTERS] = {0};
+
+  printf("# carro  eventos  vida  estado  acertos recebidos de 0..%d\n", REPORT_SHOOTERS - 1);
+  for (int c = 0; c < MATCHLOG_CARS; c++) {
+    const MatchEvent *e = matchlog_car_last(m, c);
+    if (!e) continue;
+    printf("  %5d %8llu %5u %7s ", c, (unsigned long long)m->idx->count[c], e->life,
+           e->flags & REPORT_PENALTY ? "pen." : "");
+    for (int s = 0; s < REPORT_SHOOTERS; s++) {
+      printf(" %5u", e->hits_by[s]);
+      scored[s] += e->hits_by[s];
+    }
+    printf("\n");
+  }
+  printf("# acertos feitos:");
+  for (int s = 0; s < REPORT_SHOOTERS; s++) printf(" %u:%u", s, scored[s]);
+  printf("\n");
+}
+
+int main(int argc, char **argv) {
+  int car = -1, kind = 0, quiet = 0, window = 0, usage = 0, opt;
+  double t0 = 0, t1 = 1e12;
+
+  while ((opt = getopt(argc, argv, "c:t:k:q")) != -1) {
+    switch (opt) {
+    case 'c': car = atoi(optarg); break;
+    case 't': {
+      char *end;
+      window = 1;
+      t0 = strtod(optarg, &end);
+      if (*end == ',') t1 = strtod(end + 1, NULL);
+      break;
+    }
+    case 'k':
+      for (kind = MATCH_BOOT; kind && strcmp(optarg, kinds[kind]); kind--) {}
+      if (!kind) usage = 1;
+      break;
+    case 'q': quiet = 1; break;
+    default: usage = 1; break;
+    }
+  }
+  if (usage || optind != argc - 1 || car >= MATCHLOG_CARS) {
+    fprintf(stderr, "uso: %s [-c carro] [-t ini[,fim]] [-k report|hit|boot] [-q] partida.log\n", argv[0]);
+    return 1;
+  }
+
+  MatchLog m;
+  if (matchlog_open(&m, argv[optind], 0) < 0) return 1;
+  uint64_t count = matchlog_count(&m);
+  printf("# %llu eventos, %u blocos de índice\n", (unsigned long long)count, m.idx->blocks);
+
+  double start = now_s();
+  long listed = 0;
+  if (car < 0 && !window) {
+    scoreboard(&m);
+  } else {
+    uint64_t from = m.hdr->start_us + (uint64_t)(t0 * 1e6), to = m.hdr->start_us + (uint64_t)(t1 * 1e6);
+    if (!quiet) printf("#    tempo(s) carro tipo   seq  gap vida lat aceit perd flg atr  acertos recebidos\n");
+    if (car >= 0) {
+      MatchIter it;
+      const MatchEvent *e;
+      matchlog_car_range(&m, &it, car, from, to);
+      while ((e = matchlog_car_next(&it))) {
+        if (kind && e->kind != kind) continue;
+        listed++;
+        if (!quiet) print_event(&m, e);
+      }
+    } else {
+      for (uint64_t i = matchlog_seek(&m, from); i < count && m.ev[i].t_us <= to; i++) {
+        if (kind && m.ev[i].kind != kind) continue;
+        listed++;
+        if (!quiet) print_event(&m, &m.ev[i]);
+      }
+    }
+  }
+  double took = now_s() - start;
+  if (car >= 0 || window) printf("# %ld eventos listados", listed);
+  else printf("# placar");
+  printf(" em %.3f ms\n", took * 1e3);
+
+  matchlog_close(&m);
+  return 0;
+}
@@ -0,0 +1,249 @@
+/**
+ * @file motorsim.c
+ * @brief Modelo ciclo a ciclo da atualização da ponte H no PC.
+ *
+ * Compara a sequência antiga (motor(LEFT, ...) seguido de motor(RIGHT, ...),
+ * com quatro escritas separadas em PORTD e Timer0/Timer2 fora de fase) com
+ * motors_set() (OCRs bufferizados e direção aplicada em uma única escrita no
+ * BOTTOM do PWM, com os dois timers sincronizados e a espera de guarda
+ * antes do BOTTOM).
+ *
+ * Para cada troca de comando mede, por motor:
+ *  - freio: ciclos com o motor habilitado e IN1 = IN2 (ou IN3 = IN4);
+ *  - contramão: ciclos com o motor habilitado empurrando com a direção de um
+ *    comando e o duty do outro, durante uma inversão de sentido;
+ *  - custo: ciclos de CPU gastos na atualização.
+ *
+ * Os tempos de cada escrita vêm da contagem de instruções do código em -Os
+ * (sbi/cbi e sts de 2 ciclos, call/ret de 4, entrada e saída de ISR); não são
+ * medidos em hardware.
+ *
+ * Uso: motorsim [-n trocas] [-s semente]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#define IN2 1
+#define IN1 2
+#define IN4 4
+#define IN3 5
+
+#define PWM_PRESCALER 8
+#define PWM_PERIOD    (256 * PWM_PRESCALER)
+
+typedef enum {EV_PIN, EV_OCR0A, EV_OCR2B, EV_ARM_OVF, EV_END} EventType;
+
+typedef struct {
+  uint16_t at;     // ciclo relativo ao início da atualização
+  uint8_t  type;
+  uint8_t  pin;
+  uint8_t  value;
+} Event;
+
+typedef struct {
+  long updates;
+  long cost;
+  long brake;
+  long wrong;
+  long brake_max;
+  long wrong_max;
+} Result;
+
+static uint32_t rng = 1;
+static uint32_t rand32(void) {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+/*
+ motor() antigo, por motor: call (4) + switch (6), IN1 com if/else e sbi/cbi
+ (4), IN2 (4), analog_write: call + comparações + sts + ret (14), ret (4).
+*/
+static int legacy_script(Event *ev, int16_t left, int16_t right) {
+  int n = 0;
+  uint16_t t = 0;
+  const int16_t cmd[2] = {left, right};
+  const uint8_t pa[2] = {IN1, IN3}, pb[2] = {IN2, IN4};
+
+  for (int m = 0; m < 2; m++) {
+    uint8_t dir = cmd[m] > 0;
+    uint8_t duty = cmd[m] >= 0 ? cmd[m] : -cmd[m];
+    ev[n++] = (Event){t + 14, EV_PIN, pa[m], dir};
+    ev[n++] = (Event){t + 18, EV_PIN, pb[m], !dir};
+    ev[n++] = (Event){t + 30, m == 0 ? EV_OCR0A : EV_OCR2B, 0, duty};
+    t += 34;
+  }
+  ev[n++] = (Event){t, EV_END, 0, 0};
+  return n;
+}
+
+/*
+ motors_set(): call (4), máscara e módulos (16), espera de guarda (lds TCNT0 +
+ cpi + brsh, 4), cli + sts OCR0A + sts OCR2B (6), compara a direção (4); se
+ mudou, sts + out TIFR0 + lds/ori/sts TIMSK0 (9); restaura SREG e ret (5).
+ A ISR do overflow custa ~36 ciclos e escreve PORTD ~20 ciclos depois do BOTTOM.
+*/
+#define OVF_WRITE_LATENCY 20
+#define OVF_ISR_CYCLES    36
+#define GUARD_AT          20  // ciclo em que motors_set() lê TCNT0
+#define GUARD_TOP         250 // MOTOR_GUARD_TOP do firmware
+
+static int atomic_script(Event *ev, int16_t left, int16_t right, uint8_t dir_changed) {
+  int n = 0;
+  ev[n++] = (Event){28, EV_OCR0A, 0, left  >= 0 ? left  : -left};
+  ev[n++] = (Event){30, EV_OCR2B, 0, right >= 0 ? right : -right};
+  if (dir_changed) {
+    ev[n++] = (Event){43, EV_ARM_OVF, 0, 0};
+    ev[n++] = (Event){48, EV_END, 0, 0};
+  } else {
+    ev[n++] = (Event){39, EV_END, 0, 0};
+  }
+  return n;
+}
+
+/**
+ * @brief Atrasa o script enquanto TCNT0 estiver na faixa de guarda.
+ */
+static void guard_shift(Event *ev, int n, long phase0) {
+  long count = ((GUARD_AT + phase0) % PWM_PERIOD) / PWM_PRESCALER;
+  if (count < GUARD_TOP) return;
+
+  // Relê TCNT0 a cada 4 ciclos até ele voltar para o início
+  long wait = 0;
+  while (((GUARD_AT + wait + phase0) % PWM_PERIOD) / PWM_PRESCALER >= GUARD_TOP) wait += 4;
+  for (int i = 0; i < n; i++) ev[i].at += wait;
+}
+
+static uint8_t dir_mask(int16_t left, int16_t right, int legacy) {
+  // A versão antiga usa dir = (y > 0); motors_set() usa left >= 0
+  uint8_t lf = legacy ? left > 0 : left >= 0;
+  uint8_t rf = legacy ? right > 0 : right >= 0;
+  return (lf ? 1 << IN1 : 1 << IN2) | (rf ? 1 << IN3 : 1 << IN4);
+}
+
+/**
+ * @brief Simula uma troca de comando old -> new e acumula as métricas.
+ */
+static void simulate(Result *r, int legacy, int16_t ol, int16_t orr, int16_t nl, int16_t nr) {
+  Event ev[8];
+  uint8_t old_dir = dir_mask(ol, orr, legacy), new_dir = dir_mask(nl, nr, legacy);
+  int n = legacy ? legacy_script(ev, nl, nr) : atomic_script(ev, nl, nr, old_dir != new_dir);
+
+  uint8_t old_duty[2] = {ol >= 0 ? ol : -ol, orr >= 0 ? orr : -orr};
+  uint8_t new_duty[2] = {nl >= 0 ? nl : -nl, nr >= 0 ? nr : -nr};
+  uint8_t ocr_buf[2] = {old_duty[0], old_duty[1]};
+  uint8_t ocr_act[2] = {old_duty[0], old_duty[1]};
+  uint8_t portd = old_dir;
+
+  // Fase dos timers em relação ao início da atualização
+  long phase0 = rand32() % PWM_PERIOD;
+  long phase2 = legacy ? rand32() % PWM_PERIOD : phase0;
+  if (!legacy) guard_shift(ev, n, phase0);
+
+  long armed = 0, ovf_write = -1, brake = 0, wrong = 0;
+  int e = 0;
+  long cost = 0;
+
+  for (long t = 0; t < 3 * PWM_PERIOD; t++) {
+    for (; e < n && ev[e].at == t; e++) {
+      switch (ev[e].type) {
+      case EV_PIN:
+        if (ev[e].value) portd |= 1 << ev[e].pin;
+        else             portd &= ~(1 << ev[e].pin);
+        break;
+      case EV_OCR0A: ocr_buf[0] = ev[e].value; break;
+      case EV_OCR2B: ocr_buf[1] = ev[e].value; break;
+      case EV_ARM_OVF: armed = 1; break;
+      case EV_END: cost = t; break;
+      }
+    }
+
+    // BOTTOM: o OCR bufferizado passa a valer (e a ISR do overflow é chamada)
+    if ((t + phase0) % PWM_PERIOD == 0) {
+      ocr_act[0] = ocr_buf[0];
+      if (armed) {
+        armed = 0;
+        ovf_write = t + OVF_WRITE_LATENCY;
+        cost += OVF_ISR_CYCLES;
+      }
+    }
+    if ((t + phase2) % PWM_PERIOD == 0) ocr_act[1] = ocr_buf[1];
+    if (t == ovf_write) portd = new_dir;
+
+    long count[2] = {((t + phase0) % PWM_PERIOD) / PWM_PRESCALER,
+                     ((t + phase2) % PWM_PERIOD) / PWM_PRESCALER};
+    const uint8_t pa[2] = {IN1, IN3}, pb[2] = {IN2, IN4};
+
+    for (int m = 0; m < 2; m++) {
+      // Fast PWM não invertido: nível alto do BOTTOM até o OCR (inclusive)
+      if (count[m] > ocr_act[m]) continue;
+
+      uint8_t a = (portd >> pa[m]) & 1, b = (portd >> pb[m]) & 1;
+      uint8_t was_fwd = (old_dir >> pa[m]) & 1, is_fwd = (new_dir >> pa[m]) & 1;
+
+      if (a == b) {
+        brake++;
+      } else if (was_fwd != is_fwd) {
+        // Inversão: contramão é direção nova com duty antigo ou o contrário
+        if ((a == is_fwd && ocr_act[m] == old_duty[m] && old_duty[m] != new_duty[m]) ||
+            (a == was_fwd && ocr_act[m] == new_duty[m] && old_duty[m] != new_duty[m]))
+          wrong++;
+      }
+    }
+  }
+
+  r->updates++;
+  r->cost += cost;
+  r->brake += brake;
+  r->wrong += wrong;
+  if (brake > r->brake_max) r->brake_max = brake;
+  if (wrong > r->wrong_max) r->wrong_max = wrong;
+}
+
+static int16_t rand_cmd(void) {
+  return (int16_t)(rand32() % 511) - 255;
+}
+
+static void report(const char *name, Result r) {
+  printf("  %-12s custo %5.1f ciclos  freio %7.1f (máx %5ld)  contramão %7.1f (máx %5ld)\n", name,
+         (double)r.cost / r.updates, (double)r.brake / r.updates, r.brake_max,
+         (double)r.wrong / r.updates, r.wrong_max);
+}
+
+int main(int argc, char **argv) {
+  long updates = 20000;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+    switch (opt) {
+    case 'n': updates = atol(optarg); break;
+    case 's': rng = (uint32_t)atol(optarg) | 1; break;
+    default:
+      fprintf(stderr, "uso: %s [-n trocas] [-s semente]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  printf("ciclos de CPU por atualização; freio e contramão em ciclos com o motor habilitado\n");
+
+  const char *scenario[3] = {"comandos aleatórios", "inversão 200 -> -200 (sem slew)", "inversão 4 -> -4 (slew 4)"};
+  for (int sc = 0; sc < 3; sc++) {
+    Result legacy = {0}, atomic = {0};
+    for (long i = 0; i < updates; i++) {
+      int16_t ol, orr, nl, nr;
+      if (sc == 0)      { ol = rand_cmd(); orr = rand_cmd(); nl = rand_cmd(); nr = rand_cmd(); }
+      else if (sc == 1) { ol = 200; orr = -200; nl = -200; nr = 200; }
+      else              { ol = 4; orr = -4; nl = -4; nr = 4; }
+      simulate(&legacy, 1, ol, orr, nl, nr);
+      simulate(&atomic, 0, ol, orr, nl, nr);
+    }
+    printf("%s:\n", scenario[sc]);
+    report("motor() x2", legacy);
+    report("motors_set()", atomic);
+  }
+  return 0;
+}
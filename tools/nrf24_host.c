@@ -0,0 +1,39 @@
+/**
+ * @file nrf24_host.c
+ * @brief Despacha o nrf24_hal.h para o backend escolhido.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "nrf24_host.h"
+
+static const Nrf24Backend *backend;
+
+void nrf24_host_use(const Nrf24Backend *b) {
+  backend = b;
+}
+
+static const Nrf24Backend *get(void) {
+  if (!backend) {
+    fprintf(stderr, "nrf24: nenhum backend (falta o nrf24_host_use)\n");
+    exit(1);
+  }
+  return backend;
+}
+
+void nrf24_hal_begin(uint8_t ce_pin, uint8_t csn_pin, uint32_t spi_speed_hz) {
+  // o CE começa baixo, como os pinos do AVR depois do reset
+  get()->begin(spi_speed_hz);
+  get()->ce(0);
+}
+
+void nrf24_hal_ce(uint8_t level) {
+  get()->ce(level);
+}
+
+void nrf24_hal_xfer(Nrf24Xfer *x, uint8_t n) {
+  get()->xfer(x, n);
+}
+
+void nrf24_hal_delay_us(uint32_t us) {
+  get()->delay_us(us);
+}
@@ -0,0 +1,35 @@
+/**
+ * @file nrf24_host.h
+ * @brief nrf24_hal.h no PC: o mesmo nrf24.c do firmware, com o rádio num
+ *        spidev do Linux ou no modelo do nrf24_mock.c.
+ *
+ * O backend é escolhido em tempo de execução com nrf24_host_use(), antes do
+ * primeiro nrf24_begin*(). Os números de pino que o firmware passa para o
+ * nrf24_begin_config() não valem no PC: o CE e o spidev vêm do
+ * nrf24_linux_open().
+ */
+#ifndef NRF24_HOST_H
+#define NRF24_HOST_H
+
+#include <stdint.h>
+#include "nrf24_hal.h"
+
+typedef struct {
+  void (*begin)(uint32_t spi_speed_hz);
+  void (*ce)(uint8_t level);
+  void (*xfer)(Nrf24Xfer *x, uint8_t n);
+  void (*delay_us)(uint32_t us);
+} Nrf24Backend;
+
+extern const Nrf24Backend nrf24_linux;  // nrf24_linux.c
+extern const Nrf24Backend nrf24_mock;   // nrf24_mock.c
+
+void nrf24_host_use(const Nrf24Backend *b);
+
+/**
+ * @brief Abre o spidev (modo 0, 8 bits) e pede a linha do CE ao gpiochip.
+ * @return 0, ou -1 com a mensagem do erro já impressa.
+ */
+int nrf24_linux_open(const char *spidev, const char *gpiochip, unsigned ce_line);
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * @file nrf24_linux.c
+ * @brief Backend do nrf24_host.h num spidev do Linux (Raspberry Pi e afins).
+ *
+ * O CSN é o chip select do próprio spidev. Cada nrf24_hal_xfer() vira um
+ * único ioctl SPI_IOC_MESSAGE com cs_change entre as transações, então as
+ * leituras em lote do nrf24.c (carga + limpeza do STATUS) custam uma
+ * chamada ao kernel em vez de duas. O CE é uma linha de GPIO pedida pela
+ * interface de caracteres (/dev/gpiochipN), sem sysfs.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <linux/spi/spidev.h>
+#include "nrf24_host.h"
+
+#define MAX_XFERS 8  // transações num lote (o nrf24.c usa até 3)
+
+static int spi_fd = -1;
+static int ce_fd = -1;
+static uint32_t speed_hz;
+
+int nrf24_linux_open(const char *spidev, const char *gpiochip, unsigned ce_line) {
+  uint8_t mode = SPI_MODE_0, bits = 8;
+
+  spi_fd = open(spidev, O_RDWR);
+  if (spi_fd < 0) {
+    perror(spidev);
+    return -1;
+  }
+  if (ioctl(spi_fd, SPI_IOC_WR_MODE, &mode) < 0 || ioctl(spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) {
+    perror("spidev: modo");
+    return -1;
+  }
+
+  int chip = open(gpiochip, O_RDONLY);
+  if (chip < 0) {
+    perror(gpiochip);
+    return -1;
+  }
+  struct gpiohandle_request req = {0};
+  req.lineoffsets[0] = ce_line;
+  req.flags = GPIOHANDLE_REQUEST_OUTPUT;
+  req.lines = 1;
+  strcpy(req.consumer_label, "nrf24-ce");
+  int r = ioctl(chip, GPIO_GET_LINEHANDLE_IOCTL, &req);
+  close(chip);
+  if (r < 0) {
+    fprintf(stderr, "%s: linha %u: ", gpiochip, ce_line);
+    perror(NULL);
+    return -1;
+  }
+  ce_fd = req.fd;
+  return 0;
+}
+
+static void linux_begin(uint32_t spi_speed_hz) {
+  if (spi_fd < 0) {
+    fprintf(stderr, "nrf24: spidev não aberto (falta o nrf24_linux_open)\n");
+    exit(1);
+  }
+  speed_hz = spi_speed_hz;
+  if (ioctl(spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz) < 0) perror("spidev: velocidade");
+}
+
+static void linux_ce(uint8_t level) {
+  struct gpiohandle_data d = {0};
+  d.values[0] = level != 0;
+  if (ioctl(ce_fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &d) < 0) perror("gpio: CE");
+}
+
+static void linux_xfer(Nrf24Xfer *x, uint8_t n) {
+  struct spi_ioc_transfer t[MAX_XFERS];
+
+  if (n > MAX_XFERS) {
+    fprintf(stderr, "nrf24: lote de %u transações (máximo %d)\n", n, MAX_XFERS);
+    exit(1);
+  }
+  memset(t, 0, sizeof(t));
+  for (uint8_t i = 0; i < n; i++) {
+    t[i].tx_buf = (uintptr_t)x[i].buf;
+    t[i].rx_buf = (uintptr_t)x[i].buf;
+    t[i].len = x[i].len;
+    t[i].speed_hz = speed_hz;
+    t[i].cs_change = i + 1 < n;  // CSN sobe entre as transações do lote
+  }
+  if (ioctl(spi_fd, SPI_IOC_MESSAGE(n), t) < 0) {
+    perror("spidev");
+    exit(1);
+  }
+}
+
+static void linux_delay_us(uint32_t us) {
+  struct timespec ts = {us / 1000000, (us % 1000000) * 1000L};
+  while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {}
+}
+
+const Nrf24Backend nrf24_linux = {linux_begin, linux_ce, linux_xfer, linux_delay_us};
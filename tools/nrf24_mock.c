@@ -0,0 +1,178 @@
+/**
+ * @file nrf24_mock.c
+ * @brief Modelo do nRF24L01+ (nrf24_mock.h) e o backend nrf24_mock.
+ */
+#include <string.h>
+#include "nrf24_mock.h"
+#include "nRF24L01.h"
+
+Nrf24Mock nrf24_mock_radio;
+
+static uint8_t status(const Nrf24Mock *m) {
+  uint8_t pipe = m->rx_n ? m->rx[0].pipe : 7;
+  return (m->reg[NRF_STATUS][0] & 0x70) | pipe << RX_P_NO | (m->tx_n == NRF24_MOCK_FIFO) << TX_FULL;
+}
+
+static uint8_t fifo_status(const Nrf24Mock *m) {
+  return (m->tx_n == NRF24_MOCK_FIFO) << FIFO_FULL | (m->tx_n == 0) << TX_EMPTY |
+         (m->rx_n == NRF24_MOCK_FIFO) << RX_FULL | (m->rx_n == 0) << RX_EMPTY;
+}
+
+static void pop(Nrf24MockPayload *fifo, int *n) {
+  memmove(fifo, fifo + 1, (NRF24_MOCK_FIFO - 1) * sizeof(*fifo));
+  (*n)--;
+}
+
+// W_TX_PAYLOAD_NO_ACK só vale com EN_DYN_ACK; sem ele o rádio ignora o comando
+static int tx_command(const Nrf24Mock *m) {
+  return m->cmd == W_TX_PAYLOAD || (m->cmd == W_TX_PAYLOAD_NO_ACK && (m->reg[FEATURE][0] & (1 << EN_DYN_ACK)));
+}
+
+void nrf24_mock_reset(Nrf24Mock *m) {
+  static const uint8_t pipe_lsb[4] = {0xC3, 0xC4, 0xC5, 0xC6};
+
+  memset(m, 0, sizeof(*m));
+  m->reg[NRF_CONFIG][0] = 0x08;
+  m->reg[EN_AA][0] = 0x3F;
+  m->reg[EN_RXADDR][0] = 0x03;
+  m->reg[SETUP_AW][0] = 0x03;
+  m->reg[SETUP_RETR][0] = 0x03;
+  m->reg[RF_CH][0] = 0x02;
+  m->reg[RF_SETUP][0] = 0x0E;
+  memset(m->reg[RX_ADDR_P0], 0xE7, 5);
+  memset(m->reg[RX_ADDR_P1], 0xC2, 5);
+  for (int p = 0; p < 4; p++) m->reg[RX_ADDR_P2 + p][0] = pipe_lsb[p];
+  memset(m->reg[TX_ADDR], 0xE7, 5);
+  m->cmd = 0xFF;
+  m->ack = 1;
+  m->airtime_us = 300;
+}
+
+uint8_t nrf24_mock_byte(Nrf24Mock *m, uint8_t b) {
+  if (m->idx++ == 0) {
+    m->cmd = b;
+    if (b == FLUSH_TX) {
+      m->tx_n = 0;
+      m->tx_end = 0;  // o quadro no ar (CE já baixo) não termina mais
+    }
+    if (b == FLUSH_RX) m->rx_n = 0;
+    return status(m);
+  }
+  int k = m->idx - 2;
+  uint8_t r = m->cmd & REGISTER_MASK;
+  if (m->cmd < W_REGISTER) {
+    if (r == NRF_STATUS) return status(m);
+    if (r == FIFO_STATUS) return fifo_status(m);
+    return m->reg[r][k < 5 ? k : 4];
+  }
+  if ((m->cmd & ~REGISTER_MASK) == W_REGISTER) {
+    if (r == NRF_STATUS) m->reg[r][0] &= ~(b & 0x70);  // escrever 1 limpa
+    else if (r != FIFO_STATUS && k < 5) m->reg[r][k] = b;
+    return 0;
+  }
+  if (m->cmd == R_RX_PL_WID) return m->rx_n ? m->rx[0].len : 0;
+  if (m->cmd == R_RX_PAYLOAD) return m->rx_n && k < m->rx[0].len ? m->rx[0].data[k] : 0;
+  if (tx_command(m) && m->tx_n < NRF24_MOCK_FIFO && k < 32) {
+    m->tx[m->tx_n].data[k] = b;
+    m->tx[m->tx_n].len = k + 1;
+    m->tx[m->tx_n].no_ack = m->cmd == W_TX_PAYLOAD_NO_ACK;
+  }
+  return 0;
+}
+
+void nrf24_mock_deselect(Nrf24Mock *m) {
+  if (m->idx > 1) {
+    if (m->cmd == R_RX_PAYLOAD && m->rx_n) pop(m->rx, &m->rx_n);
+    if (tx_command(m) && m->tx_n < NRF24_MOCK_FIFO) m->tx_n++;
+  }
+  m->idx = 0;
+  m->cmd = 0xFF;
+}
+
+static void start_tx(Nrf24Mock *m) {
+  uint8_t cfg = m->reg[NRF_CONFIG][0];
+  if (m->tx_end || !m->tx_n || !(cfg & (1 << PWR_UP)) || (cfg & (1 << PRIM_RX))) return;
+  m->tx_end = m->now_us + (m->airtime_us ? m->airtime_us : 1);
+}
+
+void nrf24_mock_ce(Nrf24Mock *m, int level) {
+  if (level && !m->ce) start_tx(m);
+  m->ce = level;
+}
+
+void nrf24_mock_advance(Nrf24Mock *m, uint32_t us) {
+  m->now_us += us;
+  if (!m->tx_end || m->now_us < m->tx_end) return;
+  m->tx_end = 0;
+  if (!m->ack && !m->tx[0].no_ack) {
+    // o quadro fica na FIFO até o FLUSH_TX, como no rádio
+    m->reg[NRF_STATUS][0] |= 1 << MAX_RT;
+    m->dropped++;
+    return;
+  }
+  m->last_sent = m->tx[0];
+  pop(m->tx, &m->tx_n);
+  m->reg[NRF_STATUS][0] |= 1 << TX_DS;
+  m->sent++;
+  if (m->ce) start_tx(m);  // CE alto em TX esvazia a FIFO
+}
+
+static int pipe_match(const Nrf24Mock *m, int p, const uint8_t *addr, int aw) {
+  if (p < 2) return memcmp(m->reg[RX_ADDR_P0 + p], addr, aw) == 0;
+  // pipes 2..5 só têm o byte menos significativo; o resto vem do pipe 1
+  return addr[0] == m->reg[RX_ADDR_P0 + p][0] && memcmp(m->reg[RX_ADDR_P1] + 1, addr + 1, aw - 1) == 0;
+}
+
+int nrf24_mock_inject(Nrf24Mock *m, const uint8_t *addr, const void *buf, uint8_t len) {
+  uint8_t cfg = m->reg[NRF_CONFIG][0];
+  if (!m->ce || !(cfg & (1 << PWR_UP)) || !(cfg & (1 << PRIM_RX))) return 0;
+
+  int aw = (m->reg[SETUP_AW][0] & 3) + 2;
+  int dynamic = m->reg[FEATURE][0] & (1 << EN_DPL);
+  for (int p = 0; p < 6; p++) {
+    if (!(m->reg[EN_RXADDR][0] & 1 << p) || !pipe_match(m, p, addr, aw)) continue;
+    uint8_t width = dynamic && (m->reg[DYNPD][0] & 1 << p) ? len : m->reg[RX_PW_P0 + p][0];
+    if (!width || width > 32 || len != width) return 0;
+    if (m->rx_n == NRF24_MOCK_FIFO) {
+      m->overflow++;
+      return 0;
+    }
+    Nrf24MockPayload *q = &m->rx[m->rx_n++];
+    q->pipe = p;
+    q->len = len;
+    memcpy(q->data, buf, len);
+    m->reg[NRF_STATUS][0] |= 1 << RX_DR;
+    m->received++;
+    return 1;
+  }
+  return 0;
+}
+
+/*** Backend do nrf24_host.h ***/
+
+static void mock_begin(uint32_t spi_speed_hz) {
+  // o rádio liga uma vez; depois disso guarda os registradores entre os
+  // nrf24_begin*(), como num reset do AVR
+  static int powered;
+  if (!powered) nrf24_mock_reset(&nrf24_mock_radio);
+  powered = 1;
+}
+
+static void mock_ce(uint8_t level) {
+  nrf24_mock_ce(&nrf24_mock_radio, level);
+}
+
+static void mock_xfer(Nrf24Xfer *x, uint8_t n) {
+  nrf24_mock_radio.batches++;
+  for (; n; n--, x++) {
+    for (uint8_t i = 0; i < x->len; i++) x->buf[i] = nrf24_mock_byte(&nrf24_mock_radio, x->buf[i]);
+    nrf24_mock_deselect(&nrf24_mock_radio);
+    nrf24_mock_radio.xfers++;
+  }
+}
+
+static void mock_delay_us(uint32_t us) {
+  nrf24_mock_advance(&nrf24_mock_radio, us);
+}
+
+const Nrf24Backend nrf24_mock = {mock_begin, mock_ce, mock_xfer, mock_delay_us};
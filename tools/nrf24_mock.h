@@ -0,0 +1,63 @@
+/**
+ * @file nrf24_mock.h
+ * @brief nRF24L01+ emulado byte a byte na SPI, para testar sem o rádio.
+ *
+ * Tem o banco de registradores com os valores de reset, as FIFOs de 3
+ * quadros de RX (com o pipe de cada um em RX_P_NO) e de TX, os comandos de
+ * FIFO e de carga, e a escrita de 1 para limpar os bits do STATUS. O ar é
+ * simplificado: quem usa o modelo entrega quadros com nrf24_mock_inject() e
+ * o envio termina airtime_us depois do pulso do CE, com TX_DS (ou MAX_RT se
+ * ack for 0 e o quadro pedia confirmação).
+ *
+ * O backend nrf24_mock do nrf24_host.h usa o rádio nrf24_mock_radio e conta
+ * o tempo só pelos nrf24_hal_delay_us(), então os testes não esperam de
+ * verdade.
+ */
+#ifndef NRF24_MOCK_H
+#define NRF24_MOCK_H
+
+#include <stdint.h>
+#include "nrf24_host.h"
+
+#define NRF24_MOCK_FIFO 3
+
+typedef struct {
+  uint8_t  pipe;    // RX: pipe que recebeu
+  uint8_t  no_ack;  // TX: W_TX_PAYLOAD_NO_ACK (não espera confirmação)
+  uint8_t  len;
+  uint8_t  data[32];
+} Nrf24MockPayload;
+
+typedef struct {
+  uint8_t  reg[32][5];   // endereços têm 5 bytes; os outros registradores usam só o [0]
+  uint8_t  cmd;
+  int      idx;          // byte da transação (0 = comando)
+  Nrf24MockPayload rx[NRF24_MOCK_FIFO], tx[NRF24_MOCK_FIFO];
+  int      rx_n, tx_n;
+  int      ce;
+  int      ack;          // o outro lado confirma os envios
+  uint32_t airtime_us;   // do pulso do CE ao TX_DS
+  uint64_t now_us;
+  uint64_t tx_end;       // 0 = nenhum envio no ar
+  Nrf24MockPayload last_sent;
+  long     sent, received, overflow, dropped;
+  long     xfers, batches;  // transações SPI e chamadas ao nrf24_hal_xfer
+} Nrf24Mock;
+
+extern Nrf24Mock nrf24_mock_radio;
+
+void    nrf24_mock_reset(Nrf24Mock *m);
+uint8_t nrf24_mock_byte(Nrf24Mock *m, uint8_t b);  // um byte com o CSN baixo
+void    nrf24_mock_deselect(Nrf24Mock *m);         // CSN sobe: fecha a transação
+void    nrf24_mock_ce(Nrf24Mock *m, int level);
+void    nrf24_mock_advance(Nrf24Mock *m, uint32_t us);
+
+/**
+ * @brief Um quadro chega pelo ar para o endereço addr.
+ * @return 1 se entrou na FIFO de RX; 0 se o rádio não estava ouvindo, o
+ *         endereço ou a largura não batem com nenhum pipe ligado, ou a FIFO
+ *         estava cheia (conta em overflow).
+ */
+int nrf24_mock_inject(Nrf24Mock *m, const uint8_t *addr, const void *buf, uint8_t len);
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ * @file powerbudget.c
+ * @brief Estimativa de consumo e autonomia do controle no PC.
+ *
+ * Para cada período de envio compara os três modos de espera do controle
+ * (POWER_MODE em controle.c):
+ *  - busy: CPU ativa o tempo todo (espera girando);
+ *  - idle: CPU ativa só durante o envio e em Idle no resto;
+ *  - wdt:  CPU em Power-down entre envios, acordada pelo watchdog (cada
+ *          despertar paga a partida do cristal, 16K ciclos).
+ *
+ * O rádio fica em standby-I entre envios nos três casos; cada envio custa o
+ * PLL (130us) e o ar em TX, mais a virada para RX e o ACK quando há ACK.
+ *
+ * As correntes são típicas dos datasheets (ATmega328P a 5V/16MHz e
+ * nRF24L01+ a 0dBm), não medidas. O tempo acordado por envio pode vir do
+ * firmware (power.awake_us em controle.c) com -a.
+ *
+ * Uso: powerbudget [-a acordado_us] [-p carga_bytes] [-x outras_mA]
+ *                  [-b bateria_mAh] [-r] [-d dormente_%]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// ATmega328P, 5V, 16MHz (mA)
+#define I_ACTIVE   9.5
+#define I_IDLE     2.8
+#define I_PD_WDT   0.006
+#define I_PD       0.0001
+#define T_WAKE_US  1000.0  // 16K CK de partida do cristal ao sair do Power-down
+
+// nRF24L01+ (mA)
+#define I_TX       11.3
+#define I_RX       13.5
+#define I_STBY1    0.026
+#define I_RF_PD    0.0009
+
+#define T_SETTLE_US 130.0
+#define T_ADC_US    208.0  // duas conversões de 13 ciclos a 125kHz, em Idle/ADC NR
+
+static double airtime_us(int bytes) {
+  return (1 + 5 + bytes + 2) * 8 + 9;
+}
+
+typedef struct {
+  double mcu;
+  double radio;
+  double total;
+} Budget;
+
+static double awake_us = 600;   // envio: SPI, pulso de CE e espera do TX_DS/ACK
+static int payload = 5;
+static double other_ma = 1.0;   // potenciômetros do manche (2 x 10k a 5V)
+static double battery_mah = 2000;
+static int ack = 1;
+
+/**
+ * @brief Corrente média (mA) com um envio a cada period_us.
+ */
+static Budget budget(const char *mode, double period_us) {
+  Budget b;
+  double busy = awake_us / period_us;
+  double adc = T_ADC_US / period_us;
+  if (busy + adc > 1) busy = 1 - adc;
+
+  if (mode[0] == 'b') {
+    b.mcu = I_ACTIVE;
+  } else if (mode[0] == 'i') {
+    b.mcu = I_ACTIVE * busy + I_IDLE * (1 - busy);
+  } else {
+    double wake = T_WAKE_US / period_us;
+    double down = 1 - busy - adc - wake;
+    if (down < 0) down = 0;
+    b.mcu = I_ACTIVE * busy + I_IDLE * (adc + wake) + I_PD_WDT * down;
+  }
+
+  double tx = (T_SETTLE_US + airtime_us(payload)) / period_us;
+  double rx = ack ? (T_SETTLE_US + airtime_us(0)) / period_us : 0;
+  b.radio = I_TX * tx + I_RX * rx + I_STBY1 * (1 - tx - rx);
+  b.total = b.mcu + b.radio + other_ma;
+  return b;
+}
+
+/**
+ * @brief Corrente média dormente (rádio e CPU desligados, só as outras cargas).
+ */
+static double dormant_ma(void) {
+  return I_PD + I_RF_PD + other_ma;
+}
+
+int main(int argc, char **argv) {
+  double dormant = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "a:p:x:b:rd:")) != -1) {
+    switch (opt) {
+    case 'a': awake_us = atof(optarg); break;
+    case 'p': payload = atoi(optarg); break;
+    case 'x': other_ma = atof(optarg); break;
+    case 'b': battery_mah = atof(optarg); break;
+    case 'r': ack = 0; break;
+    case 'd': dormant = atof(optarg) / 100; break;
+    default:
+      fprintf(stderr, "uso: %s [-a acordado_us] [-p carga_bytes] [-x outras_mA] [-b bateria_mAh] [-r] [-d dormente_%%]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  printf("acordado %.0fus por envio, carga %d bytes, %s, outras cargas %.2fmA, bateria %.0fmAh\n",
+         awake_us, payload, ack ? "com ACK" : "sem ACK", other_ma, battery_mah);
+  if (dormant > 0) printf("%.0f%% do tempo dormente (sem botão por DORMANT_S)\n", dormant * 100);
+  printf("período |  modo | CPU mA  rádio mA  total mA |  autonomia h\n");
+
+  static const double periods_ms[] = {10, 16, 20, 50, 100};
+  static const char *modes[] = {"busy", "idle", "wdt"};
+  for (unsigned i = 0; i < sizeof(periods_ms) / sizeof(periods_ms[0]); i++) {
+    for (unsigned m = 0; m < 3; m++) {
+      Budget b = budget(modes[m], periods_ms[i] * 1000);
+      double avg = b.total * (1 - dormant) + dormant_ma() * dormant;
+      printf("%5.0fms | %5s | %6.3f  %8.3f  %8.3f | %11.1f\n", periods_ms[i], modes[m],
+             b.mcu, b.radio, b.total, battery_mah / avg);
+    }
+  }
+  printf("wdt: o período real é o do watchdog (16ms nominal, ±10%%), não o HOP_PERIOD_MS\n");
+  return 0;
+}
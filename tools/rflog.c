@@ -0,0 +1,208 @@
+/**
+ * @file rflog.c
+ * @brief Escuta o canal do carrinho num PC com Linux e imprime os quadros.
+ *
+ * Roda o mesmo nrf24.c do firmware pelo nrf24_host.h, com um nRF24L01+ no
+ * spidev (Raspberry Pi e afins) configurado como o carrinho: radio_config
+ * do radiocfg.h, via nrf24_begin_config(). Cada quadro aceito vira uma
+ * linha (tempo, seq, eixos, botões, quadros perdidos antes dele, latência)
+ * e no fim sai o resumo do frame_rx_accept(), igual ao do carrinho.
+ *
+ * O rádio do PC confirma (auto-ack) no mesmo endereço do carrinho: com os
+ * dois ligados, os ACKs colidem e o controle vê retransmissões que não
+ * aconteceriam só com o carrinho.
+ *
+ * Com -m não precisa de rádio: o backend é o nrf24_mock.c, que recebe
+ * quadros do frame_tx_encode() a cada 20ms (do tempo virtual, sem esperar)
+ * com a perda de -p. Confere o banco de registradores depois da
+ * configuração (canal, largura, endereço, modo), o boot a quente, se cada
+ * quadro lido é o que foi enviado e se nenhum se perdeu na FIFO. Sai com 1
+ * se algo não bate.
+ *
+ * Uso: rflog [-m] [-n quadros] [-p perda] [-q] [-d spidev] [-g gpiochip] [-c linha]
+ *   -m  sem rádio, contra o modelo (padrão: 500 quadros)
+ *   -n  para depois de tantos quadros (0 = até o Ctrl-C)
+ *   -p  probabilidade de perder cada quadro com -m (padrão 0.05)
+ *   -q  só o resumo
+ *   -d  spidev do rádio (padrão /dev/spidev0.0)
+ *   -g  gpiochip do CE (padrão /dev/gpiochip0)
+ *   -c  linha do CE no gpiochip (padrão 25)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include "nrf24_host.h"
+#include "nrf24_mock.h"
+#include "radiocfg.h"
+#include "frame.h"
+
+#define FRAME_MS 20  // período de envio do controle
+
+static const Nrf24Config radio_config = {
+  RADIO_CHANNEL, sizeof(Frame), 0x03, RADIO_RF_SETUP, 0, 0, 1, RADIO_ADDRESS,
+};
+
+static volatile sig_atomic_t stop;
+static void on_signal(int sig) { stop = 1; }
+
+static uint32_t rng = 1;
+static double frand(void) {
+  rng = rng * 1664525u + 1013904223u;
+  return (rng >> 8) / 16777216.0;
+}
+
+static int errors;
+static void check(int ok, const char *what) {
+  if (ok) return;
+  fprintf(stderr, "rflog: %s\n", what);
+  errors++;
+}
+
+static uint64_t now_us(int mock) {
+  if (mock) return nrf24_mock_radio.now_us;
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000ull + t.tv_nsec / 1000;
+}
+
+/*** Controle de mentira para o -m ***/
+
+typedef struct {
+  FrameTx  tx;
+  uint64_t next_us;
+  long     count, lost;
+  Controls sent[256];  // o que foi enviado com cada seq
+} Feeder;
+
+static void feed(Feeder *fd, long frames, double loss) {
+  Nrf24Mock *m = &nrf24_mock_radio;
+  static const uint8_t addr[5] = RADIO_ADDRESS;
+
+  while (fd->count < frames && m->now_us >= fd->next_us) {
+    double t = fd->next_us / 1e6;
+    Controls c = {(int8_t)(127 * sin(t)), (int8_t)(100 * cos(0.7 * t)), (fd->count / 50) & 1, fd->count % 37 == 0};
+    uint8_t seq = fd->tx.seq;
+    Frame f;
+    frame_tx_encode(&fd->tx, &f, &c, fd->next_us / 1000);
+    fd->sent[seq] = c;
+    fd->count++;
+    fd->next_us += FRAME_MS * 1000;
+    if (frand() < loss) fd->lost++;
+    else check(nrf24_mock_inject(m, addr, &f, sizeof(f)), "quadro recusado pelo rádio");
+  }
+}
+
+static void check_registers(void) {
+  const Nrf24Mock *m = &nrf24_mock_radio;
+  const uint8_t addr[5] = RADIO_ADDRESS;
+
+  check(m->reg[RF_CH][0] == RADIO_CHANNEL, "RF_CH diferente do radiocfg.h");
+  check(m->reg[RX_PW_P0][0] == sizeof(Frame), "RX_PW_P0 diferente do tamanho do quadro");
+  check(memcmp(m->reg[RX_ADDR_P0], addr, 5) == 0, "RX_ADDR_P0 diferente do radiocfg.h");
+  check(m->reg[RF_SETUP][0] == RADIO_RF_SETUP, "RF_SETUP diferente do radiocfg.h");
+  check(m->reg[EN_RXADDR][0] == 0x01 && m->reg[EN_AA][0] == 0x01, "pipes diferentes do carrinho");
+  check((m->reg[NRF_CONFIG][0] & (1 << PWR_UP | 1 << PRIM_RX)) == (1 << PWR_UP | 1 << PRIM_RX) && m->ce,
+        "rádio não ficou ouvindo");
+}
+
+int main(int argc, char **argv) {
+  const char *spidev = "/dev/spidev0.0", *gpiochip = "/dev/gpiochip0";
+  unsigned ce_line = 25;
+  int mock = 0, quiet = 0, opt;
+  long frames = -1;
+  double loss = 0.05;
+
+  while ((opt = getopt(argc, argv, "mn:p:qd:g:c:")) != -1) {
+    switch (opt) {
+    case 'm': mock = 1; break;
+    case 'n': frames = atol(optarg); break;
+    case 'p': loss = atof(optarg); break;
+    case 'q': quiet = 1; break;
+    case 'd': spidev = optarg; break;
+    case 'g': gpiochip = optarg; break;
+    case 'c': ce_line = atoi(optarg); break;
+    default:
+      fprintf(stderr, "uso: %s [-m] [-n quadros] [-p perda] [-q] [-d spidev] [-g gpiochip] [-c linha]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (frames < 0) frames = mock ? 500 : 0;
+
+  if (mock) {
+    nrf24_host_use(&nrf24_mock);
+  } else {
+    if (nrf24_linux_open(spidev, gpiochip, ce_line) < 0) return 1;
+    nrf24_host_use(&nrf24_linux);
+  }
+
+  uint8_t warm = nrf24_begin_config(9, 10, RF24_SPI_SPEED, &radio_config);
+  nrf24_startListening();
+  if (mock) {
+    check(!warm, "rádio recém-ligado reportado como configurado");
+    check_registers();
+    // mesmo boot de novo, como depois de um reset do AVR: nada a regravar
+    check(nrf24_begin_config(9, 10, RF24_SPI_SPEED, &radio_config), "boot a quente regravou registradores");
+    nrf24_startListening();
+    check_registers();
+    // o linktest a 1Mbps deixou o rádio ligado noutra taxa: tem de regravar
+    nrf24_mock_radio.reg[RF_SETUP][0] = NRF24_RF_SETUP(RF24_1MBPS, 3);
+    check(!nrf24_begin_config(9, 10, RF24_SPI_SPEED, &radio_config), "taxa de outro firmware aceita como boot a quente");
+    nrf24_startListening();
+    check_registers();
+  } else if (!quiet) {
+    printf("# canal %u, %s\n", nrf24_getChannel(), warm ? "rádio já configurado" : "rádio configurado");
+  }
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  FrameRx link;
+  frame_rx_begin(&link);
+  Feeder fd = {0};
+  frame_tx_begin(&fd.tx, FRAME_REDUNDANCY);
+  long got = 0, wrong = 0;
+  uint64_t t0 = now_us(mock);
+
+  if (!quiet) printf("#    tempo   seq     x     y sw tr perd lat\n");
+  while (!stop) {
+    if (mock) {
+      feed(&fd, frames, loss);
+      if (fd.count == frames && !nrf24_available()) break;
+    } else if (frames && got >= frames) {
+      break;
+    }
+
+    if (!nrf24_available()) {
+      nrf24_hal_delay_us(1000);
+      continue;
+    }
+    Frame f;
+    Controls c;
+    nrf24_read(&f, sizeof(f));
+    got++;
+    uint64_t t = now_us(mock) - t0;
+    if (!frame_rx_accept(&link, &f, t / 1000) || !frame_decode(&f, &c)) continue;
+    if (mock && memcmp(&c, &fd.sent[f.seq], sizeof(c))) wrong++;
+    if (!quiet)
+      printf("%10.3f %5u %5d %5d %2d %2d %4u %3u\n", t / 1e6, f.seq, c.x, c.y, c.sw, c.trigger, link.gap,
+             link.latency);
+  }
+
+  printf("# %ld quadros lidos: %u aceitos, %u duplicados, %u fora de ordem, %u perdidos, %u reconstruídos, "
+         "%u de outra versão\n",
+         got, link.accepted, link.duplicated, link.reordered, link.lost, link.recovered, link.bad_version);
+  if (mock) {
+    const Nrf24Mock *m = &nrf24_mock_radio;
+    printf("# modelo: %ld enviados, %ld perdidos no ar, %ld na FIFO; %ld transações SPI em %ld chamadas\n",
+           fd.count, fd.lost, m->overflow, m->xfers, m->batches);
+    check(got == fd.count - fd.lost, "quadros lidos diferentes dos entregues");
+    check(!m->overflow, "quadros perdidos na FIFO de RX");
+    check(!wrong, "quadros lidos diferentes dos enviados");
+  }
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,522 @@
+/**
+ * @file telemdecode.c
+ * @brief Decodifica a telemetria dos firmwares (telem.h) e resume enlace e laço.
+ *
+ * Lê o fluxo binário de uma serial (-d, configurada crua em UART_BAUD), de
+ * um arquivo gravado ou da entrada padrão, e:
+ *  - exporta cada registro em JSON (uma linha por registro, -j) e em CSV,
+ *    um arquivo por tipo com colunas fixas (-c prefixo: prefixo-link.csv...);
+ *  - resume no fim (e a cada -i segundos na serial) a perda e a latência do
+ *    enlace, o tempo do laço, os envios do controle, tiros, resets e as
+ *    janelas do linktest (pacotes/s, perda, jitter); -s grava o resumo em
+ *    JSON.
+ *
+ * O relógio dos registros tem 16 bits em ms: o tempo é desenrolado pela
+ * diferença entre registros seguidos (t_ms), o que exige pelo menos um
+ * registro a cada 65s (o LINK do carrinho e o POWER do controle bastam). Um
+ * TELEM_RESET começa um novo boot: o relógio recomeça do ts dele e os
+ * contadores cumulativos do enlace voltam a zero.
+ *
+ * Os campos vêm das próprias structs de telem.h (offsetof), então o
+ * decodificador acompanha o formato do firmware ao recompilar.
+ *
+ * Na serial lê em blocos grandes e só escreve a saída com buffer: a 1Mbaud
+ * chegam ~100kB/s, folga grande para não perder bytes do buffer do tty.
+ *
+ * Uso: telemdecode [-d tty] [-b baud] [-c prefixo] [-j arquivo|-]
+ *                  [-s resumo.json] [-i segundos] [arquivo]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
+#include "telemrx.h"
+#include "trace.h"
+#include "frame.h"
+#include "report.h"
+#include "wdog.h"
+#include "uart.h"
+
+typedef struct {
+  const char *name;
+  uint8_t off;
+  uint8_t size;    // 1, 2 ou 4 bytes
+  uint8_t n;       // elementos (vetores viram nome0, nome1...)
+  uint8_t sign;
+} Field;
+
+#define F(T, f)     {#f, offsetof(T, f), sizeof(((T *)0)->f), 1, 0}
+#define FS(T, f)    {#f, offsetof(T, f), sizeof(((T *)0)->f), 1, 1}
+#define FA(T, f, e) {#f, offsetof(T, f), sizeof(e), sizeof(((T *)0)->f) / sizeof(e), 0}
+
+static const Field reset_fields[] = {
+  F(TelemReset, cause), F(TelemReset, stalled), F(TelemReset, restart_us),
+  FA(TelemReset, count, uint16_t), {0},
+};
+static const Field boot_fields[] = {
+  F(TelemBoot, warm), F(TelemBoot, channel), F(TelemBoot, radio_us), F(TelemBoot, first_us), {0},
+};
+static const Field loop_fields[] = {
+  F(TelemLoop, periods), F(TelemLoop, avg_us), F(TelemLoop, max_us),
+  F(TelemLoop, late), F(TelemLoop, overruns), {0},
+};
+static const Field link_fields[] = {
+  F(TelemLink, accepted), F(TelemLink, duplicated), F(TelemLink, reordered), F(TelemLink, lost),
+  F(TelemLink, recovered), F(TelemLink, resyncs), F(TelemLink, latency), F(TelemLink, channel), {0},
+};
+static const Field hit_fields[] = {
+  F(TelemHit, shooter), F(TelemHit, life), FS(TelemHit, score), FS(TelemHit, threshold),
+  F(TelemHit, ambient), F(TelemHit, active), {0},
+};
+static const Field power_fields[] = {
+  F(TelemPower, duty), F(TelemPower, awake_us), F(TelemPower, sends), F(TelemPower, failed),
+  F(TelemPower, superseded), F(TelemPower, expired), {0},
+};
+static const Field trace_fields[] = {
+  F(TraceEntry, t), F(TraceEntry, id), F(TraceEntry, arg), {0},
+};
+static const Field hist_fields[] = {
+  F(TelemHist, id), F(TelemHist, first), F(TelemHist, max), FA(TelemHist, count, uint16_t), {0},
+};
+static const Field capture_fields[] = {
+  FS(TelemCapture, left), FS(TelemCapture, right), F(TelemCapture, life), F(TelemCapture, samples), {0},
+};
+static const Field frame_fields[] = {
+  F(Frame, seq), FS(Frame, x), FS(Frame, y), F(Frame, ts), {0},
+};
+static const Field car_fields[] = {
+  F(TelemCar, pipe), F(TelemCar, fifo), F(TelemCar, report.ms), F(TelemCar, report.accepted),
+  F(TelemCar, report.lost), F(TelemCar, report.player), F(TelemCar, report.seq), F(TelemCar, report.flags),
+  F(TelemCar, report.life), F(TelemCar, report.latency), F(TelemCar, report.channel),
+  FA(TelemCar, report.hits_by, uint8_t), {0},
+};
+static const Field base_fields[] = {
+  FA(TelemBase, reports, uint16_t), F(TelemBase, full), F(TelemBase, dropped), {0},
+};
+static const Field ltest_fields[] = {
+  F(TelemLinkTest, packets), F(TelemLinkTest, lost), F(TelemLinkTest, retries), F(TelemLinkTest, dup),
+  F(TelemLinkTest, reordered), F(TelemLinkTest, jitter_avg), F(TelemLinkTest, jitter_max), F(TelemLinkTest, window_ms),
+  F(TelemLinkTest, tx), F(TelemLinkTest, payload), F(TelemLinkTest, data_rate), F(TelemLinkTest, channel), {0},
+};
+
+typedef struct {
+  const char  *name;
+  uint8_t      size;   // tamanho da carga (TRACE: de cada entrada; CAPTURE: sem as amostras)
+  const Field *fields;
+} Type;
+
+static const Type types[TELEM_TYPES] = {
+  [TELEM_RESET] = {"reset", sizeof(TelemReset), reset_fields},
+  [TELEM_BOOT]  = {"boot",  sizeof(TelemBoot),  boot_fields},
+  [TELEM_LOOP]  = {"loop",  sizeof(TelemLoop),  loop_fields},
+  [TELEM_LINK]  = {"link",  sizeof(TelemLink),  link_fields},
+  [TELEM_HIT]   = {"hit",   sizeof(TelemHit),   hit_fields},
+  [TELEM_POWER] = {"power", sizeof(TelemPower), power_fields},
+  [TELEM_TRACE] = {"trace", sizeof(TraceEntry), trace_fields},
+  [TELEM_HIST]  = {"hist",  sizeof(TelemHist),  hist_fields},
+  [TELEM_CAPTURE] = {"capture", sizeof(TelemCapture), capture_fields},
+  [TELEM_FRAME]   = {"frame",   sizeof(Frame),        frame_fields},
+  [TELEM_CAR]     = {"car",     sizeof(TelemCar),     car_fields},
+  [TELEM_BASE]    = {"base",    sizeof(TelemBase),    base_fields},
+  [TELEM_LTEST]   = {"ltest",   sizeof(TelemLinkTest), ltest_fields},
+};
+
+static long field(const uint8_t *p, const Field *f, int i) {
+  p += f->off + i * f->size;
+  uint32_t v = 0;
+  for (int k = f->size - 1; k >= 0; k--) v = v << 8 | p[k];
+  if (f->sign && f->size == 1) return (int8_t)v;
+  if (f->sign && f->size == 2) return (int16_t)v;
+  if (f->sign) return (int32_t)v;
+  return v;
+}
+
+/*** Saída por registro ***/
+
+static FILE *json = NULL;
+static const char *csv_prefix = NULL;
+static FILE *csv[TELEM_TYPES];
+
+static void csv_header(FILE *f, const Type *t) {
+  fprintf(f, "t_ms,boot");
+  for (const Field *fl = t->fields; fl->name; fl++) {
+    if (fl->n == 1) fprintf(f, ",%s", fl->name);
+    else for (int i = 0; i < fl->n; i++) fprintf(f, ",%s%d", fl->name, i);
+  }
+  fputc('\n', f);
+}
+
+static FILE *csv_file(uint8_t type) {
+  if (!csv[type]) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s-%s.csv", csv_prefix, types[type].name);
+    if (!(csv[type] = fopen(path, "w"))) {
+      perror(path);
+      exit(1);
+    }
+    csv_header(csv[type], &types[type]);
+  }
+  return csv[type];
+}
+
+static void emit(uint64_t t_ms, int boot, uint8_t type, const uint8_t *p) {
+  const Type *t = &types[type];
+  if (json) {
+    fprintf(json, "{\"t_ms\":%llu,\"boot\":%d,\"type\":\"%s\"", (unsigned long long)t_ms, boot, t->name);
+    for (const Field *f = t->fields; f->name; f++) {
+      if (f->n == 1) {
+        fprintf(json, ",\"%s\":%ld", f->name, field(p, f, 0));
+      } else {
+        fprintf(json, ",\"%s\":[", f->name);
+        for (int i = 0; i < f->n; i++) fprintf(json, "%s%ld", i ? "," : "", field(p, f, i));
+        fputc(']', json);
+      }
+    }
+    fputs("}\n", json);
+  }
+  if (csv_prefix) {
+    FILE *f = csv_file(type);
+    fprintf(f, "%llu,%d", (unsigned long long)t_ms, boot);
+    for (const Field *fl = t->fields; fl->name; fl++)
+      for (int i = 0; i < fl->n; i++) fprintf(f, ",%ld", field(p, fl, i));
+    fputc('\n', f);
+  }
+}
+
+/*** Estatísticas ***/
+
+typedef struct {
+  long     per_type[TELEM_TYPES];
+  long     unknown;
+  int      boots;
+  long     resets[RESET_CAUSES];
+  uint64_t span_ms;
+
+  // TELEM_LOOP (janelas)
+  long     loop_windows;
+  uint64_t loop_periods;
+  double   loop_busy_us;   // soma de avg_us * periods
+  unsigned loop_max_us;
+  long     loop_late, loop_overruns;
+
+  // TELEM_LINK (contadores cumulativos: somam as diferenças)
+  uint16_t link_prev[6];
+  int      link_have_prev;
+  uint64_t link_sum[6];    // accepted, duplicated, reordered, lost, recovered, resyncs
+  double   link_worst_loss; // maior perda entre dois registros seguidos (%)
+  long     lat_n;
+  double   lat_sum;
+  unsigned lat_max;
+  long     lat_hist[8];    // latency em faixas de 0-1, 2-3, 4-7... ms
+
+  // TELEM_POWER
+  long     power_windows;
+  uint64_t sends, failed, superseded, expired;
+  double   duty_sum, awake_sum;
+
+  // TELEM_LTEST (janelas do linktest)
+  TelemLinkTest lt_last;
+  long     lt_windows;
+  uint64_t lt_ms, lt_packets, lt_lost, lt_retries, lt_dup, lt_reordered;
+  double   lt_jitter_sum;  // jitter_avg * packets
+  unsigned lt_jitter_max;
+  double   lt_worst_pps;
+
+  long     hits[4];
+  TelemBoot boot;
+  int      have_boot;
+} Stats;
+
+static Stats st;
+
+static void account(uint8_t type, const uint8_t *p) {
+  st.per_type[type]++;
+  switch (type) {
+  case TELEM_RESET: {
+    TelemReset r;
+    memcpy(&r, p, sizeof(r));
+    st.boots++;
+    if (r.cause < RESET_CAUSES) st.resets[r.cause]++;
+    st.link_have_prev = 0;  // o carrinho recomeçou os contadores
+    break;
+  }
+  case TELEM_BOOT:
+    memcpy(&st.boot, p, sizeof(st.boot));
+    st.have_boot = 1;
+    break;
+  case TELEM_LOOP: {
+    TelemLoop r;
+    memcpy(&r, p, sizeof(r));
+    st.loop_windows++;
+    st.loop_periods += r.periods;
+    st.loop_busy_us += (double)r.avg_us * r.periods;
+    if (r.max_us > st.loop_max_us) st.loop_max_us = r.max_us;
+    st.loop_late += r.late;
+    st.loop_overruns += r.overruns;
+    break;
+  }
+  case TELEM_LINK: {
+    TelemLink r;
+    memcpy(&r, p, sizeof(r));
+    uint16_t now[6] = {r.accepted, r.duplicated, r.reordered, r.lost, r.recovered, r.resyncs};
+    uint16_t d[6];
+    for (int i = 0; i < 6; i++) {
+      // Sem TELEM_RESET (telemetria ligada depois do boot), o primeiro conta desde zero
+      d[i] = now[i] - (st.link_have_prev ? st.link_prev[i] : 0);
+      st.link_sum[i] += d[i];
+      st.link_prev[i] = now[i];
+    }
+    st.link_have_prev = 1;
+    if (d[0] + d[3]) {
+      double loss = 100.0 * d[3] / (d[0] + d[3]);
+      if (loss > st.link_worst_loss) st.link_worst_loss = loss;
+    }
+    st.lat_n++;
+    st.lat_sum += r.latency;
+    if (r.latency > st.lat_max) st.lat_max = r.latency;
+    int b = 0;
+    while (b < 7 && (r.latency >> (b + 1))) b++;
+    st.lat_hist[b]++;
+    break;
+  }
+  case TELEM_LTEST: {
+    TelemLinkTest r;
+    memcpy(&r, p, sizeof(r));
+    st.lt_last = r;
+    st.lt_windows++;
+    st.lt_ms += r.window_ms;
+    st.lt_packets += r.packets;
+    st.lt_lost += r.lost;
+    st.lt_retries += r.retries;
+    st.lt_dup += r.dup;
+    st.lt_reordered += r.reordered;
+    st.lt_jitter_sum += (double)r.jitter_avg * r.packets;
+    if (r.jitter_max > st.lt_jitter_max) st.lt_jitter_max = r.jitter_max;
+    double pps = r.window_ms ? 1000.0 * r.packets / r.window_ms : 0;
+    if (st.lt_windows == 1 || pps < st.lt_worst_pps) st.lt_worst_pps = pps;
+    break;
+  }
+  case TELEM_HIT: {
+    TelemHit r;
+    memcpy(&r, p, sizeof(r));
+    if (r.shooter < 4) st.hits[r.shooter]++;
+    break;
+  }
+  case TELEM_POWER: {
+    TelemPower r;
+    memcpy(&r, p, sizeof(r));
+    st.power_windows++;
+    st.sends += r.sends;
+    st.failed += r.failed;
+    st.superseded += r.superseded;
+    st.expired += r.expired;
+    st.duty_sum += r.duty;
+    st.awake_sum += r.awake_us;
+    break;
+  }
+  }
+}
+
+static double pct(double a, double b) {
+  return b ? 100.0 * a / b : 0;
+}
+
+static void report_text(FILE *f, const TelemRx *rx) {
+  fprintf(f, "registros %ld, descartados %ld, bytes pulados %ld, %.1fs, %d boots\n",
+          rx->records, rx->bad, rx->skipped, st.span_ms / 1000.0, st.boots);
+  for (int t = 1; t < TELEM_TYPES; t++)
+    if (st.per_type[t]) fprintf(f, "  %-7s %ld\n", types[t].name, st.per_type[t]);
+  if (st.unknown) fprintf(f, "  tipos desconhecidos %ld\n", st.unknown);
+
+  if (st.boots) {
+    static const char *causes[RESET_CAUSES] = {"energia", "externo", "brown-out", "watchdog", "?"};
+    fprintf(f, "resets:");
+    for (int i = 0; i < RESET_CAUSES; i++) if (st.resets[i]) fprintf(f, " %s %ld", causes[i], st.resets[i]);
+    fputc('\n', f);
+  }
+  if (st.have_boot)
+    fprintf(f, "boot: rádio %s no canal %u em %uus, primeiro quadro em %.1fms\n", st.boot.warm ? "quente" : "frio",
+            st.boot.channel, st.boot.radio_us, st.boot.first_us / 1000.0);
+  if (st.loop_windows)
+    fprintf(f, "laço: %llu períodos, trabalho médio %.1fus, máx %uus, atrasados %ld (%.3f%%), estourados %ld (%.3f%%)\n",
+            (unsigned long long)st.loop_periods, st.loop_busy_us / st.loop_periods, st.loop_max_us,
+            st.loop_late, pct(st.loop_late, st.loop_periods), st.loop_overruns, pct(st.loop_overruns, st.loop_periods));
+  if (st.lat_n) {
+    uint64_t *s = st.link_sum;
+    fprintf(f, "enlace: %llu aceitos, %llu perdidos (%.2f%%, pior janela %.1f%%), %llu recuperados, "
+               "%llu duplicados, %llu fora de ordem, %llu ressincronizações\n",
+            (unsigned long long)s[0], (unsigned long long)s[3], pct(s[3], s[0] + s[3]), st.link_worst_loss,
+            (unsigned long long)s[4], (unsigned long long)s[1], (unsigned long long)s[2], (unsigned long long)s[5]);
+    fprintf(f, "latência acima do mínimo: média %.1fms, máx %ums;", st.lat_sum / st.lat_n, st.lat_max);
+    for (int b = 0; b < 8; b++)
+      if (st.lat_hist[b]) fprintf(f, " %d-%dms %.1f%%", b ? 1 << b : 0, (2 << b) - 1, pct(st.lat_hist[b], st.lat_n));
+    fputc('\n', f);
+  }
+  if (st.power_windows)
+    fprintf(f, "controle: %llu envios, %llu sem ACK (%.2f%%, %llu vencidos), %llu substituídos, "
+               "acordado %.1f%% do tempo, %.0fus por envio\n",
+            (unsigned long long)st.sends, (unsigned long long)st.failed, pct(st.failed, st.sends),
+            (unsigned long long)st.expired, (unsigned long long)st.superseded, st.duty_sum / st.power_windows / 10, st.awake_sum / st.power_windows);
+  if (st.lt_windows) {
+    static const char *rates[] = {"1Mbps", "2Mbps", "250kbps"};
+    const TelemLinkTest *l = &st.lt_last;
+    fprintf(f, "linktest %s, canal %u, %s, %uB: %.1f pacotes/s (pior janela %.1f), %s %.3f%%, "
+               "%llu retransmissões, %llu repetidos, %llu fora de ordem, jitter médio %.0fus, máx %uus\n",
+            l->tx ? "TX" : "RX", l->channel, l->data_rate < 3 ? rates[l->data_rate] : "?", l->payload,
+            st.lt_ms ? 1000.0 * st.lt_packets / st.lt_ms : 0, st.lt_worst_pps, l->tx ? "sem ACK" : "PER",
+            pct(st.lt_lost, st.lt_packets + st.lt_lost), (unsigned long long)st.lt_retries,
+            (unsigned long long)st.lt_dup, (unsigned long long)st.lt_reordered,
+            st.lt_packets ? st.lt_jitter_sum / st.lt_packets : 0, st.lt_jitter_max);
+  }
+  if (st.per_type[TELEM_HIT])
+    fprintf(f, "tiros por jogador: %ld %ld %ld %ld\n", st.hits[0], st.hits[1], st.hits[2], st.hits[3]);
+  fflush(f);
+}
+
+static void report_json(FILE *f, const TelemRx *rx) {
+  uint64_t *s = st.link_sum;
+  fprintf(f, "{\n  \"records\": %ld, \"bad\": %ld, \"skipped\": %ld, \"span_ms\": %llu, \"boots\": %d,\n",
+          rx->records, rx->bad, rx->skipped, (unsigned long long)st.span_ms, st.boots);
+  fprintf(f, "  \"per_type\": {");
+  for (int t = 1; t < TELEM_TYPES; t++) fprintf(f, "%s\"%s\": %ld", t > 1 ? ", " : "", types[t].name, st.per_type[t]);
+  fprintf(f, "},\n  \"resets\": [");
+  for (int i = 0; i < RESET_CAUSES; i++) fprintf(f, "%s%ld", i ? ", " : "", st.resets[i]);
+  fprintf(f, "],\n  \"loop\": {\"periods\": %llu, \"avg_us\": %.2f, \"max_us\": %u, \"late\": %ld, \"overruns\": %ld},\n",
+          (unsigned long long)st.loop_periods, st.loop_periods ? st.loop_busy_us / st.loop_periods : 0,
+          st.loop_max_us, st.loop_late, st.loop_overruns);
+  fprintf(f, "  \"link\": {\"accepted\": %llu, \"duplicated\": %llu, \"reordered\": %llu, \"lost\": %llu, "
+             "\"recovered\": %llu, \"resyncs\": %llu, \"loss_pct\": %.3f, \"worst_loss_pct\": %.2f, "
+             "\"latency_avg_ms\": %.2f, \"latency_max_ms\": %u},\n",
+          (unsigned long long)s[0], (unsigned long long)s[1], (unsigned long long)s[2], (unsigned long long)s[3],
+          (unsigned long long)s[4], (unsigned long long)s[5], pct(s[3], s[0] + s[3]), st.link_worst_loss,
+          st.lat_n ? st.lat_sum / st.lat_n : 0, st.lat_max);
+  fprintf(f, "  \"power\": {\"sends\": %llu, \"failed\": %llu, \"ack_loss_pct\": %.3f, \"superseded\": %llu, "
+             "\"expired\": %llu, \"duty_pct\": %.2f, \"awake_us\": %.1f},\n",
+          (unsigned long long)st.sends, (unsigned long long)st.failed, pct(st.failed, st.sends),
+          (unsigned long long)st.superseded, (unsigned long long)st.expired,
+          st.power_windows ? st.duty_sum / st.power_windows / 10 : 0,
+          st.power_windows ? st.awake_sum / st.power_windows : 0);
+  fprintf(f, "  \"linktest\": {\"windows\": %ld, \"packets\": %llu, \"lost\": %llu, \"retries\": %llu, "
+             "\"dup\": %llu, \"reordered\": %llu, \"pps\": %.1f, \"worst_pps\": %.1f, \"loss_pct\": %.3f, "
+             "\"jitter_avg_us\": %.1f, \"jitter_max_us\": %u},\n",
+          st.lt_windows, (unsigned long long)st.lt_packets, (unsigned long long)st.lt_lost,
+          (unsigned long long)st.lt_retries, (unsigned long long)st.lt_dup, (unsigned long long)st.lt_reordered,
+          st.lt_ms ? 1000.0 * st.lt_packets / st.lt_ms : 0, st.lt_worst_pps,
+          pct(st.lt_lost, st.lt_packets + st.lt_lost), st.lt_packets ? st.lt_jitter_sum / st.lt_packets : 0,
+          st.lt_jitter_max);
+  fprintf(f, "  \"hits\": [%ld, %ld, %ld, %ld]\n}\n", st.hits[0], st.hits[1], st.hits[2], st.hits[3]);
+}
+
+/*** Entrada ***/
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig) {
+  stop = 1;
+}
+
+int main(int argc, char **argv) {
+  const char *tty = NULL, *summary = NULL;
+  int interval = 0, baud = UART_BAUD;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "d:b:c:j:s:i:")) != -1) {
+    switch (opt) {
+    case 'd': tty = optarg; break;
+    case 'b': baud = atoi(optarg); break;
+    case 'c': csv_prefix = optarg; break;
+    case 'j':
+      if (!strcmp(optarg, "-")) json = stdout;
+      else if (!(json = fopen(optarg, "w"))) { perror(optarg); return 1; }
+      break;
+    case 's': summary = optarg; break;
+    case 'i': interval = atoi(optarg); break;
+    default:
+      fprintf(stderr, "uso: %s [-d tty] [-b baud] [-c prefixo] [-j arquivo|-] [-s resumo.json] [-i segundos] [arquivo]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  int fd = 0;
+  if (tty) fd = telemrx_open_tty(tty, baud);
+  else if (optind < argc && (fd = open(argv[optind], O_RDONLY)) < 0) {
+    perror(argv[optind]);
+    return 1;
+  }
+  FILE *text = json == stdout ? stderr : stdout;
+
+  // Ctrl+C na serial: o read() volta com EINTR e o resumo sai normalmente
+  struct sigaction sa = {.sa_handler = on_signal};
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  TelemRx rx = {0};
+  uint64_t t_ms = 0;
+  uint16_t last_ts = 0;
+  int started = 0;
+  time_t last_report = time(NULL);
+  static uint8_t buf[1 << 16];
+  ssize_t n;
+
+  while (!stop && (n = read(fd, buf, sizeof(buf))) > 0) {
+    for (ssize_t i = 0; i < n; i++) {
+      if (!telemrx_push(&rx, buf[i])) continue;
+      uint8_t type = telemrx_type(&rx), len = telemrx_len(&rx);
+      uint16_t ts = telemrx_ts(&rx);
+      const uint8_t *p = telemrx_payload(&rx);
+
+      if (type == TELEM_RESET) {
+        t_ms += started ? ts : 0;  // o intervalo até o reset é desconhecido
+        last_ts = ts;
+      }
+      if (!started) {
+        started = 1;
+        last_ts = ts;
+      }
+      t_ms += (uint16_t)(ts - last_ts);
+      last_ts = ts;
+      st.span_ms = t_ms;
+
+      if (type == 0 || type >= TELEM_TYPES || !types[type].size) {
+        st.unknown++;
+        continue;
+      }
+      if (type == TELEM_TRACE) {
+        for (int k = 0; k + sizeof(TraceEntry) <= len; k += sizeof(TraceEntry))
+          emit(t_ms, st.boots, type, p + k);
+        st.per_type[type]++;
+        continue;
+      }
+      // As amostras do LDR do CAPTURE ficam para o carreplay
+      if (type == TELEM_CAPTURE ? len < types[type].size : len != types[type].size) {
+        st.unknown++;
+        continue;
+      }
+      account(type, p);  // antes do emit(): o RESET já é do boot novo
+      emit(t_ms, st.boots, type, p);
+    }
+    if (tty) {
+      if (json) fflush(json);
+      if (interval && time(NULL) - last_report >= interval) {
+        last_report = time(NULL);
+        report_text(stderr, &rx);
+      }
+    }
+  }
+
+  report_text(text, &rx);
+  if (summary) {
+    FILE *f = fopen(summary, "w");
+    if (!f) { perror(summary); return 1; }
+    report_json(f, &rx);
+    fclose(f);
+  }
+  if (json && json != stdout) fclose(json);
+  for (int t = 0; t < TELEM_TYPES; t++) if (csv[t]) fclose(csv[t]);
+  return 0;
+}
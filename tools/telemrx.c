@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+#include "telemrx.h"
+
+/**
+ * @brief Confere o que já chegou: -1 inválido, 0 incompleto, 1 registro pronto.
+ */
+static int check(const TelemRx *rx) {
+  if (rx->have < TELEM_HEADER) return 0;
+  uint8_t len = rx->rec[2];
+  if (len > TELEM_MAX_PAYLOAD) return -1;
+  if (rx->have < TELEM_HEADER + len + 1) return 0;
+  return rx->rec[TELEM_HEADER + len] == telem_checksum(rx->rec, len) ? 1 : -1;
+}
+
+/**
+ * @brief Descarta o sincronismo falso e recomeça do próximo 0xA5 já lido.
+ */
+static void resync(TelemRx *rx) {
+  int i = 1;
+  while (i < rx->have && rx->rec[i] != TELEM_SYNC) i++;
+  rx->skipped += i - 1;
+  memmove(rx->rec, rx->rec + i, rx->have - i);
+  rx->have -= i;
+}
+
+/**
+ * @brief Entrega um byte do fluxo.
+ * @return 1 quando rx->rec tem um registro completo e com a soma certa.
+ */
+int telemrx_push(TelemRx *rx, uint8_t c) {
+  if (rx->have == 0 && c != TELEM_SYNC) {
+    rx->skipped++;
+    return 0;
+  }
+  rx->rec[rx->have++] = c;
+
+  int r;
+  while ((r = check(rx)) < 0) {
+    rx->bad++;
+    resync(rx);
+  }
+  if (r == 0) return 0;
+
+  rx->have = 0;
+  rx->records++;
+  return 1;
+}
+
+/**
+ * @brief Abre a serial crua em baud (a 1Mbaud precisa do termios2).
+ */
+int telemrx_open_tty(const char *path, int baud) {
+  int fd = open(path, O_RDONLY | O_NOCTTY);
+  if (fd < 0) {
+    perror(path);
+    exit(1);
+  }
+  struct termios2 tio;
+  if (ioctl(fd, TCGETS2, &tio) < 0) {
+    perror("TCGETS2");
+    exit(1);
+  }
+  tio.c_iflag = 0;
+  tio.c_oflag = 0;
+  tio.c_lflag = 0;
+  tio.c_cflag = CS8 | CREAD | CLOCAL | BOTHER;
+  tio.c_ispeed = tio.c_ospeed = baud;
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 0;
+  if (ioctl(fd, TCSETS2, &tio) < 0) {
+    perror("TCSETS2");
+    exit(1);
+  }
+  return fd;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file telemrx.h
+ * @brief Leitura dos registros da telemetria (telem.h) no PC, byte a byte.
+ *
+ * Procura o sincronismo, confere tamanho e soma e, se o registro não fecha,
+ * volta a procurar a partir do byte seguinte ao sincronismo falso, então
+ * nenhum registro bom é perdido por causa de lixo antes dele.
+ */
+#ifndef TELEMRX_H
+#define TELEMRX_H
+
+#include <stdint.h>
+#include "telem.h"
+
+typedef struct {
+  uint8_t rec[TELEM_MAX_RECORD]; // registro completo quando telemrx_push() retorna 1
+  int     have;
+  long    records;   // registros aceitos
+  long    bad;       // sincronismos falsos ou registros com soma errada
+  long    skipped;   // bytes descartados procurando o sincronismo
+} TelemRx;
+
+int telemrx_push(TelemRx *rx, uint8_t c);
+
+/**
+ * @brief Abre a serial crua em baud (sai do programa se não conseguir).
+ */
+int telemrx_open_tty(const char *path, int baud);
+
+/**
+ * @brief Campos do cabeçalho de um registro aceito.
+ */
+static inline uint8_t  telemrx_type(const TelemRx *rx) { return rx->rec[1]; }
+static inline uint8_t  telemrx_len(const TelemRx *rx)  { return rx->rec[2]; }
+static inline uint16_t telemrx_ts(const TelemRx *rx)   { return rx->rec[3] | rx->rec[4] << 8; }
+static inline const uint8_t *telemrx_payload(const TelemRx *rx) { return rx->rec + TELEM_HEADER; }
+
+#endif
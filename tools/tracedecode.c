@@ -0,0 +1,203 @@
+/**
+ * @file tracedecode.c
+ * @brief Monta a linha do tempo do rastro de eventos (trace.h) no PC.
+ *
+ * Lê o fluxo binário da telemetria (um arquivo gravado da serial, ou a
+ * entrada padrão), aceita só registros com a soma certa e junta os
+ * TELEM_TRACE de cada envio: o primeiro traz TR_DUMP com a quantidade de
+ * entradas que seguem. Cada envio vira uma linha do tempo (tempo desde a
+ * primeira entrada, intervalo para a anterior, evento e argumento) e um
+ * resumo das latências entre pares de eventos da cadeia do laço.
+ *
+ * O tempo das entradas tem 16 bits em us: intervalos de mais de 65ms entre
+ * duas entradas seguidas aparecem truncados.
+ *
+ * Também imprime os histogramas de tempo (TELEM_HIST, hist.h) do último
+ * envio de cada um, com o limite superior de p50, p90 e p99 (a escala é
+ * log2, então o valor real está entre a metade e o limite).
+ *
+ * Uso: tracedecode [-s] [arquivo]
+ *   -s  só o resumo das latências e os histogramas
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "telemrx.h"
+#include "trace.h"
+#include "hist.h"
+
+static const char *names[TR_EVENTS] = {
+  "-", "DUMP", "LOOP", "LOOP_END", "RX", "TX_START", "TX_DONE",
+  "ADC", "MOTOR", "HIT", "SLEEP", "WAKE",
+};
+
+typedef struct {
+  uint8_t  from, to;
+  const char *what;
+  long     n;
+  uint64_t sum;
+  uint32_t max;
+  uint8_t  pending;
+  uint64_t at;
+} Pair;
+
+// Cadeia do carrinho (tiro -> ADC -> laço -> motor) e do controle (ADC -> envio)
+static Pair pairs[] = {
+  {TR_LOOP,     TR_RX,       "laço -> quadro lido"},
+  {TR_RX,       TR_MOTOR,    "quadro lido -> motores"},
+  {TR_ADC,      TR_HIT,      "ADC -> tiro tratado"},
+  {TR_LOOP,     TR_LOOP_END, "trabalho do laço"},
+  {TR_LOOP,     TR_TX_START, "laço -> início do envio"},
+  {TR_TX_START, TR_TX_DONE,  "envio (txbox)"},
+  {TR_SLEEP,    TR_WAKE,     "dormindo"},
+};
+#define PAIRS (sizeof(pairs) / sizeof(pairs[0]))
+
+static const char *hist_names[HIST_IDS] = {
+  "período", "leitura", "rádio", "controle", "motores", "latência COMPA", "latência COMPB",
+};
+
+static Hist hists[HIST_IDS];
+static uint8_t hist_seen[HIST_IDS];
+
+static int summary_only = 0;
+
+static const char *name(uint8_t id) {
+  return id < TR_EVENTS ? names[id] : "?";
+}
+
+/**
+ * @brief Imprime um envio completo e acumula as latências.
+ */
+static void timeline(const TraceEntry *e, int n, int dump) {
+  uint64_t t = 0;
+
+  if (!summary_only) printf("# envio %d: %d entradas\n", dump, n);
+  for (unsigned k = 0; k < PAIRS; k++) pairs[k].pending = 0;
+
+  for (int i = 0; i < n; i++) {
+    uint16_t dt = i ? (uint16_t)(e[i].t - e[i - 1].t) : 0;
+    t += dt;
+    if (!summary_only)
+      printf("%10.3fms  +%6uus  %-9s %u\n", t / 1000.0, dt, name(e[i].id), e[i].arg);
+
+    for (unsigned k = 0; k < PAIRS; k++) {
+      Pair *p = &pairs[k];
+      if (e[i].id == p->to && p->pending) {
+        uint32_t d = t - p->at;
+        p->n++;
+        p->sum += d;
+        if (d > p->max) p->max = d;
+        p->pending = 0;
+      }
+      if (e[i].id == p->from) {
+        p->pending = 1;
+        p->at = t;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Limite superior (us) do bucket que contém o quantil q.
+ */
+static double quantile_us(const Hist *h, long total, double q) {
+  long acc = 0;
+  for (int b = 0; b < HIST_BUCKETS; b++) {
+    acc += h->count[b];
+    if (acc >= q * total) return b == HIST_BUCKETS - 1 ? h->max / 2.0 : (1 << b) / 2.0;
+  }
+  return h->max / 2.0;
+}
+
+static void hist_report(void) {
+  for (int id = 0; id < HIST_IDS; id++) {
+    if (!hist_seen[id]) continue;
+    const Hist *h = &hists[id];
+    long total = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) total += h->count[b];
+    if (!total) continue;
+
+    printf("# %s: %ld amostras, p50 < %.1fus, p90 < %.1fus, p99 < %.1fus, máx %.1fus\n",
+           hist_names[id], total, quantile_us(h, total, 0.5), quantile_us(h, total, 0.9),
+           quantile_us(h, total, 0.99), h->max / 2.0);
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+      if (!h->count[b]) continue;
+      double lo = b ? (1 << (b - 1)) / 2.0 : 0, hi = (1 << b) / 2.0;
+      int bar = (int)(50.0 * h->count[b] / total + 0.5);
+      printf("#   %8.1f - %8.1fus %6u %.*s\n", lo, hi, h->count[b], bar,
+             "##################################################");
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "s")) != -1) {
+    switch (opt) {
+    case 's': summary_only = 1; break;
+    default:
+      fprintf(stderr, "uso: %s [-s] [arquivo]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  FILE *in = stdin;
+  if (optind < argc && !(in = fopen(argv[optind], "rb"))) {
+    perror(argv[optind]);
+    return 1;
+  }
+
+  TelemRx rx = {0};
+  TraceEntry entries[TRACE_SIZE];
+  int expected = -1, got = 0, dumps = 0;
+  int c;
+
+  while ((c = fgetc(in)) != EOF) {
+    if (!telemrx_push(&rx, c)) continue;
+    uint8_t type = telemrx_type(&rx), len = telemrx_len(&rx);
+    const uint8_t *payload = telemrx_payload(&rx);
+
+    if (type == TELEM_HIST && len == sizeof(TelemHist)) {
+      TelemHist r;
+      memcpy(&r, payload, sizeof(r));
+      if (r.id < HIST_IDS && r.first + 8 <= HIST_BUCKETS) {
+        hists[r.id].max = r.max;
+        memcpy(&hists[r.id].count[r.first], r.count, sizeof(r.count));
+        hist_seen[r.id] = 1;
+      }
+      continue;
+    }
+    if (type != TELEM_TRACE || len % sizeof(TraceEntry)) continue;
+
+    for (uint8_t i = 0; i < len / sizeof(TraceEntry); i++) {
+      TraceEntry e;
+      memcpy(&e, payload + i * sizeof(TraceEntry), sizeof(e));
+      if (e.id == TR_DUMP && e.t == 0) {
+        if (expected > 0 && got < expected)
+          fprintf(stderr, "envio %d incompleto: %d de %d entradas\n", dumps + 1, got, expected);
+        expected = e.arg > TRACE_SIZE ? TRACE_SIZE : e.arg;
+        got = 0;
+        continue;
+      }
+      if (expected < 0 || got >= expected) continue;
+      entries[got++] = e;
+      if (got == expected) {
+        timeline(entries, got, ++dumps);
+        expected = -1;
+      }
+    }
+  }
+
+  printf("# %ld registros, %ld descartados pela soma, %d envios do rastro\n", rx.records, rx.bad, dumps);
+  printf("# latência                  n      média     máx (us)\n");
+  for (unsigned k = 0; k < PAIRS; k++) {
+    Pair *p = &pairs[k];
+    if (!p->n) continue;
+    printf("# %-24s %5ld %10.1f %8u\n", p->what, p->n, (double)p->sum / p->n, p->max);
+  }
+  hist_report();
+  return 0;
+}
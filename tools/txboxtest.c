@@ -0,0 +1,161 @@
+/**
+ * @file txboxtest.c
+ * @brief Confere a caixa de envio do controle (txbox.c) com o rádio emulado.
+ *
+ * O txbox.c, o frame.c e o nrf24.c do firmware rodam sobre o nrf24_mock.
+ * Cada cenário força o que não acontece no uso normal do controle (uma
+ * amostra trocada na vaga, um quadro vencido no ar, outro vencido na vaga)
+ * e confere os contadores e o que o carrinho vê: o seq dos quadros que foram
+ * ao ar não tem buracos por amostras que nunca saíram, e o histórico de cada
+ * quadro é o dos quadros anteriores no ar.
+ *
+ * Uso: txboxtest (sai com erro se algum cenário falhar)
+ */
+#include <stdio.h>
+#include <string.h>
+#include "nrf24_mock.h"
+#include "radiocfg.h"
+#include "txbox.h"
+
+#define MAX_AIR 8  // quadros guardados por cenário
+
+static const Nrf24Config radio_config = {
+  RADIO_CHANNEL, sizeof(Frame), 0x03, RADIO_RF_SETUP, 0, 0, 0, RADIO_ADDRESS,
+};
+
+static Nrf24Mock *const m = &nrf24_mock_radio;
+static TxBox    box;
+static FrameRx  rx;              // o carrinho, com o que saiu do rádio
+static Frame    air[MAX_AIR];    // quadros que foram ao ar, na ordem
+static int      n_air;
+static uint16_t now;
+static int      errors;
+
+static void check(int ok, const char *what) {
+  if (ok) return;
+  printf("      %s\n", what);
+  errors++;
+}
+
+/**
+ * @brief Rádio recém-ligado, caixa e carrinho zerados; cada envio leva
+ * airtime_us até o ACK.
+ */
+static void begin(uint32_t airtime_us) {
+  nrf24_mock_reset(m);
+  nrf24_begin_config(9, 10, RF24_SPI_SPEED, &radio_config);
+  m->airtime_us = airtime_us;
+  txbox_begin(&box, FRAME_REDUNDANCY);
+  frame_rx_begin(&rx);
+  n_air = 0;
+  now = 0;
+}
+
+/**
+ * @brief Anda 1ms no rádio e no laço; o carrinho recebe o que terminou.
+ * @return o TxBoxResult do txbox_poll().
+ */
+static uint8_t step(void) {
+  long sent = m->sent;
+  nrf24_mock_advance(m, 1000);
+  now++;
+  if (m->sent != sent && n_air < MAX_AIR) {
+    memcpy(&air[n_air], m->last_sent.data, sizeof(Frame));
+    frame_rx_accept(&rx, &air[n_air++], now);
+  }
+  return txbox_poll(&box, now);
+}
+
+/**
+ * @return como terminou o quadro no ar (TXBOX_IDLE se não terminou).
+ */
+static uint8_t finish(void) {
+  for (int i = 0; i < 50; i++) {
+    uint8_t r = step();
+    if (r >= TXBOX_SENT) return r;
+  }
+  return TXBOX_IDLE;
+}
+
+static void send(int8_t x) {
+  Controls c = {x, -x, 0, 0};
+  txbox_put(&box, &c, now);
+  txbox_poll(&box, now);
+}
+
+/**
+ * @brief B chega com A no ar e é trocado por C antes de sair.
+ */
+static void supersede(void) {
+  begin(300);
+  send(10);
+  send(20);
+  send(30);
+  check(box.superseded == 1, "troca na vaga não contada");
+  check(finish() == TXBOX_SENT, "A não foi confirmado");
+  check(finish() == TXBOX_SENT, "C não foi confirmado");
+  check(n_air == 2 && air[1].x == 30, "C não foi ao ar logo depois de A");
+  check(air[1].seq == (uint8_t)(air[0].seq + 1), "B gastou um seq sem ir ao ar");
+  check(rx.lost == 0, "carrinho contou B como perdido");
+#if FRAME_REDUNDANCY > 0
+  Controls h;
+  check(frame_history(&air[1], 1, &h) && h.x == 10, "histórico de C não é A");
+#endif
+}
+
+/**
+ * @brief A passa do prazo nas retransmissões e sai do rádio; B vem depois.
+ */
+static void expire_on_air(void) {
+  begin(3 * TXBOX_DEADLINE_MS * 500);
+  send(10);
+  check(finish() == TXBOX_EXPIRED, "A não venceu no ar");
+  check(box.expired == 1, "prazo vencido não contado");
+  check(m->tx_n == 0 && !m->tx_end, "A ficou no rádio");
+  m->airtime_us = 300;
+  send(20);
+  check(finish() == TXBOX_SENT, "B não foi confirmado");
+  check(n_air == 1 && air[0].x == 20, "A chegou ao carrinho");
+  // A chegou a ir ao ar: o seq dele conta, e o carrinho vê o buraco
+  check(air[0].seq == 1, "A não gastou o seq dele");
+}
+
+/**
+ * @brief B espera na vaga atrás de A até passar do prazo; C vem depois.
+ */
+static void expire_in_slot(void) {
+  begin(TXBOX_DEADLINE_MS * 1000 - 500);
+  send(10);
+  send(20);
+  check(finish() == TXBOX_SENT, "A não foi confirmado");
+  check(box.expired == 1 && !box.busy, "B foi ao ar vencido");
+  m->airtime_us = 300;
+  send(30);
+  check(finish() == TXBOX_SENT, "C não foi confirmado");
+  check(n_air == 2 && air[1].x == 30, "C não foi ao ar logo depois de A");
+  check(air[1].seq == (uint8_t)(air[0].seq + 1), "B gastou um seq sem ir ao ar");
+  check(rx.lost == 0, "carrinho contou B como perdido");
+}
+
+static const struct {
+  const char *name;
+  void (*run)(void);
+} scenarios[] = {
+  {"troca na vaga",  supersede},
+  {"vence no ar",    expire_on_air},
+  {"vence na vaga",  expire_in_slot},
+};
+
+int main(void) {
+  int failed = 0;
+  nrf24_host_use(&nrf24_mock);
+
+  for (unsigned i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+    int before = errors;
+    scenarios[i].run();
+    printf("%-5s %s (trocadas %u, vencidas %u, no ar %d)\n", errors == before ? "ok" : "FALHA",
+           scenarios[i].name, box.superseded, box.expired, n_air);
+    if (errors != before) failed++;
+  }
+  return failed != 0;
+}